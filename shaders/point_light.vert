@@ -11,11 +11,6 @@ const vec2 OFFSETS[6] = vec2[](
 
 layout (location = 0) out vec2 fragOffset;
 
-struct PointLight {
-  vec4 position; // ignore w
-  vec4 color; // w is intensity
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo {
   mat4 projection;
   mat4 view;
@@ -24,10 +19,15 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 
   vec4 ambientLightColor; // w is intensity
 
+  vec4 sunDirection;
+  vec4 sunColor;
+
   vec4 sunParams;
   vec4 sunScreen;
+
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
   
-  PointLight pointLights[400];
   int numLights;
 
   float autoExposure;
@@ -8,11 +8,6 @@ layout(set = 0, binding = 1) uniform sampler2D bloomTex;
 layout(set = 0, binding = 3) uniform sampler2D sceneDepth;
 layout(set = 0, binding = 4) uniform sampler2D lensFlareTex;
 
-struct PointLight {
-  vec4 position;
-  vec4 color;
-};
-
 layout(set = 0, binding = 2) uniform GlobalUbo {
   mat4 projection;
   mat4 view;
@@ -27,7 +22,9 @@ layout(set = 0, binding = 2) uniform GlobalUbo {
   vec4 sunParams;   // x = sunViewFactor
   vec4 sunScreen;   // xy = sunUV, z = visibility, w = intensityScale
 
-  PointLight pointLights[400];
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
+
   int numLights;
 
   float autoExposure;
@@ -4,8 +4,11 @@ layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragPosWorld;
 layout (location = 2) in vec3 fragNormalWorld;
 //layout(location = 3) in vec4 fragPosLightSpace;
+layout (location = 4) flat in uint fragLabel;
 
 layout (location = 0) out vec4 outColor;
+// ignored unless the scene pass has a label attachment
+layout (location = 1) out uint outLabel;
 
 struct PointLight {
   vec4 position; // ignore w
@@ -26,12 +29,18 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
   vec4 sunParams;
   vec4 sunScreen;
 
-  PointLight pointLights[400];
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
+
   int numLights;
 
   float autoExposure;
 } ubo;
 
+layout(std430, set = 0, binding = 3) readonly buffer PointLights {
+  PointLight pointLights[];
+};
+
 layout(set = 0, binding = 1) uniform sampler2D shadowMap;
 
 layout(push_constant) uniform Push {
@@ -116,7 +125,7 @@ return;
   vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
 
   for (int i = 0; i < ubo.numLights; i++) {
-    PointLight light = ubo.pointLights[i];
+    PointLight light = pointLights[i];
     vec3 directionToLight = light.position.xyz - fragPosWorld;
     float attenuation = 1.0 / dot(directionToLight, directionToLight); // distance squared
     directionToLight = normalize(directionToLight);
@@ -137,4 +146,5 @@ return;
   vec3 diffuseLight = ambient + sunLight + diffusePL;
   
   outColor = vec4(diffuseLight * fragColor + specularLight * fragColor, 1.0);
+  outLabel = fragLabel;
 }
@@ -9,11 +9,8 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec4 fragPosLightSpace;
-
-struct PointLight {
-  vec4 position; // ignore w
-  vec4 color; // w is intensity
-};
+// object label carried in the otherwise unused normalMatrix[3][3]
+layout(location = 4) flat out uint fragLabel;
 
 layout(std140, set = 0, binding = 0) uniform GlobalUbo {
   mat4 projection;
@@ -28,8 +25,10 @@ layout(std140, set = 0, binding = 0) uniform GlobalUbo {
 
   vec4 sunParams;
   vec4 sunScreen;
+
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
   
-  PointLight pointLights[400];
   int numLights;
 
   float autoExposure;
@@ -49,4 +48,5 @@ void main() {
   fragColor = color;
   
   fragPosLightSpace = ubo.lightViewProj * positionWorld;
+  fragLabel = uint(push.normalMatrix[3][3] + 0.5);
 }
@@ -0,0 +1,185 @@
+#version 450
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec3 fragPosWorld;
+layout (location = 2) in vec3 fragNormalWorld;
+//layout(location = 3) in vec4 fragPosLightSpace;
+layout (location = 4) flat in uint fragLabel;
+
+layout (location = 0) out vec4 outColor;
+// ignored unless the scene pass has a label attachment
+layout (location = 1) out uint outLabel;
+
+// must match LightClusterSystem
+const uint CLUSTER_X = 16u;
+const uint CLUSTER_Y = 9u;
+const uint CLUSTER_Z = 24u;
+const uint MAX_LIGHTS_PER_CLUSTER = 128u;
+
+struct PointLight {
+  vec4 position; // w is influence radius
+  vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  mat4 lightViewProj;
+  
+  vec4 ambientLightColor; 
+  
+  vec4 sunDirection;
+  vec4 sunColor;
+  
+  vec4 sunParams;
+  vec4 sunScreen;
+
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
+
+  int numLights;
+
+  float autoExposure;
+} ubo;
+
+layout(std430, set = 0, binding = 3) readonly buffer PointLights {
+  PointLight pointLights[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer ClusterCounts {
+  uint clusterCounts[];
+};
+
+layout(std430, set = 0, binding = 5) readonly buffer ClusterLights {
+  uint clusterLights[];
+};
+
+layout(set = 0, binding = 1) uniform sampler2D shadowMap;
+
+layout(push_constant) uniform Push {
+  mat4 modelMatrix;
+  mat4 normalMatrix;
+} push;
+
+
+vec3 applySunLight(vec3 normal) {
+    vec3 L = normalize(-ubo.sunDirection.xyz);
+    float NdotL = max(dot(normal, L), 0.0);
+
+    return ubo.sunColor.rgb * ubo.sunColor.a * NdotL;
+}
+
+float computeShadow(vec3 worldPos, vec3 normal) {
+    vec3 L = normalize(-ubo.sunDirection.xyz);
+    float ndotl = max(dot(normal, L), 0.0);
+
+    float normalOffset = 0.0015;
+    vec3 biasedWorldPos = worldPos + normal * normalOffset;
+    //vec3 biasedWorldPos = fragPosWorld;
+
+    vec4 posLightSpace = ubo.lightViewProj * vec4(biasedWorldPos, 1.0);
+
+    vec3 projCoords = posLightSpace.xyz / posLightSpace.w;
+    projCoords.xy = projCoords.xy * 0.5 + 0.5;
+
+    if (projCoords.x < 0.0  || projCoords.x > 1.0 || 
+        projCoords.y < 0.0 || projCoords.y > 1.0 || 
+        projCoords.z < 0.0 || projCoords.z > 1.0) {
+        return 1.0;
+    }
+
+    float bias = max(0.0005 * (1.0 - dot(normal, L)), 0.0005);
+    //float bias = 0.0;
+
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
+    float currentDepth = projCoords.z;
+
+    float sum = 0.0;
+    for (int x = -1; x <= 1; x++) {
+      for (int y = -1; y <= 1; y++) {
+        float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x,y) * texelSize).r;
+        sum += (currentDepth - bias > pcfDepth) ? 0.0 : 1.0;
+      }
+    }
+
+    return sum / 9.0;
+}
+
+uint clusterIndex(vec3 worldPos) {
+  float near = ubo.clusterParams.x;
+  float far = ubo.clusterParams.y;
+  float z = max((ubo.view * vec4(worldPos, 1.0)).z, near);
+
+  float slice = floor(log(z / near) / log(far / near) * float(CLUSTER_Z));
+  uint tileZ = uint(clamp(slice, 0.0, float(CLUSTER_Z - 1u)));
+
+  vec2 tile = floor(gl_FragCoord.xy / ubo.clusterParams.zw * vec2(CLUSTER_X, CLUSTER_Y));
+  uint tileX = uint(clamp(tile.x, 0.0, float(CLUSTER_X - 1u)));
+  uint tileY = uint(clamp(tile.y, 0.0, float(CLUSTER_Y - 1u)));
+
+  return (tileZ * CLUSTER_Y + tileY) * CLUSTER_X + tileX;
+}
+
+void main() {
+  vec3 surfaceNormal = normalize(fragNormalWorld);
+  
+  //vec3 L = normalize(ubo.sunDirection.xyz);
+  /*vec4 posLightSpace = ubo.lightViewProj * vec4(fragPosWorld, 1.0);
+
+  vec3 projCoords = posLightSpace.xyz / posLightSpace.w;
+  projCoords.xy = projCoords.xy * 0.5 + 0.5;
+
+  float d = texture(shadowMap, projCoords.xy).r;
+  outColor = vec4(vec3(d), 1.0);
+  //outColor = vec4(projCoords, 1.0);
+
+  return;
+*/
+
+/*float s = computeShadow(fragPosWorld, surfaceNormal);
+outColor = vec4(vec3(s), 1.0);
+return;
+*/
+  vec3 ambient = ubo.ambientLightColor.rgb * ubo.ambientLightColor.w;
+  
+  vec3 sunLight = applySunLight(surfaceNormal);
+  float shadowFactor = computeShadow(fragPosWorld, surfaceNormal);
+  sunLight *= shadowFactor;
+
+  vec3 diffusePL = vec3(0.0);
+  vec3 specularLight = vec3(0.0);
+  
+  vec3 cameraPosWorld = ubo.invView[3].xyz;
+  vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
+
+  uint cluster = clusterIndex(fragPosWorld);
+  uint clusterLightCount = min(clusterCounts[cluster], MAX_LIGHTS_PER_CLUSTER);
+
+  for (uint i = 0u; i < clusterLightCount; i++) {
+    PointLight light = pointLights[clusterLights[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
+    vec3 directionToLight = light.position.xyz - fragPosWorld;
+    float distanceSquared = dot(directionToLight, directionToLight);
+    // fade to zero at the influence radius so cluster borders do not show
+    float window = clamp(1.0 - distanceSquared / (light.position.w * light.position.w), 0.0, 1.0);
+    float attenuation = window * window / distanceSquared;
+    directionToLight = normalize(directionToLight);
+
+    float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
+    vec3 intensity = light.color.rgb * light.color.w * attenuation;
+
+    diffusePL += intensity * cosAngIncidence;
+
+    // specular lighting
+    vec3 halfAngle = normalize(directionToLight + viewDirection);
+    float blinnTerm = dot(surfaceNormal, halfAngle);
+    blinnTerm = clamp(blinnTerm, 0, 1);
+    blinnTerm = pow(blinnTerm, 5.0); // higher values -> sharper highlight
+    specularLight += intensity * blinnTerm;
+  }
+  
+  vec3 diffuseLight = ambient + sunLight + diffusePL;
+  
+  outColor = vec4(diffuseLight * fragColor + specularLight * fragColor, 1.0);
+  outLabel = fragLabel;
+}
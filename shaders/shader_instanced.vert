@@ -0,0 +1,51 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in vec2 uv;
+
+// per instance (binding 1)
+layout(location = 4) in mat4 instanceModelMatrix;
+layout(location = 8) in mat4 instanceNormalMatrix;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec4 fragPosLightSpace;
+// object label carried in the otherwise unused normalMatrix[3][3]
+layout(location = 4) flat out uint fragLabel;
+
+layout(std140, set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  mat4 lightViewProj;
+  
+  vec4 ambientLightColor; 
+  
+  vec4 sunDirection;
+  vec4 sunColor;
+
+  vec4 sunParams;
+  vec4 sunScreen;
+
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
+  
+  int numLights;
+
+  float autoExposure;
+} ubo;
+
+void main() {
+  vec4 positionWorld = instanceModelMatrix * vec4(position, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+  
+  fragNormalWorld = normalize(mat3(instanceNormalMatrix) * normal);
+  fragPosWorld = positionWorld.xyz;
+  fragColor = color;
+  
+  fragPosLightSpace = ubo.lightViewProj * positionWorld;
+  fragLabel = uint(instanceNormalMatrix[3][3] + 0.5);
+}
@@ -2,11 +2,6 @@
 
 layout(location = 0) in vec3 position;
 
-struct PointLight {
-  vec4 position; // ignore w
-  vec4 color; // w is intensity
-};
-
 layout(std140, set = 0, binding = 0) uniform GlobalUbo {
     mat4 projection;
     mat4 view;
@@ -20,8 +15,10 @@ layout(std140, set = 0, binding = 0) uniform GlobalUbo {
 
     vec4 sunParams;
     vec4 sunScreen;
+
+    vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+    vec4 clusterParams;    // x near, y far, zw framebuffer size
     
-    PointLight pointLights[400];
     int numLights;
 
     float autoExposure;
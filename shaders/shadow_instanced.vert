@@ -0,0 +1,33 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+
+// per instance (binding 1)
+layout(location = 4) in mat4 instanceModelMatrix;
+
+layout(std140, set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projection;
+    mat4 view;
+    mat4 invView;
+    mat4 lightViewProj;
+    
+    vec4 ambientLightColor;
+    
+    vec4 sunDirection;
+    vec4 sunColor;   
+
+    vec4 sunParams;
+    vec4 sunScreen;
+
+    vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+    vec4 clusterParams;    // x near, y far, zw framebuffer size
+    
+    int numLights;
+
+    float autoExposure;
+} ubo;
+
+void main() {
+    vec4 worldPos   = instanceModelMatrix * vec4(position, 1.0);
+    gl_Position     = ubo.lightViewProj * worldPos;
+}
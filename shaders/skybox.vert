@@ -2,11 +2,6 @@
 
 layout(location = 0) out vec3 vDir;
 
-struct PointLight {
-  vec4 position; // ignore w
-  vec4 color; // w is intensity
-};
-
 layout(set = 0, binding = 0) uniform GlobalUbo {
   mat4 projection;
   mat4 view;
@@ -20,8 +15,10 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 
   vec4 sunParams;
   vec4 sunScreen;
+
+  vec4 frustumPlanes[6]; // camera frustum, xyz normal, w distance
+  vec4 clusterParams;    // x near, y far, zw framebuffer size
   
-  PointLight pointLights[400];
   int numLights;
 
   float autoExposure;
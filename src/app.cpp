@@ -12,6 +12,16 @@
 #include "blur_render_system.hpp"
 #include "exposure_reduce_system.hpp"
 #include "exposure_update_system.hpp"
+#include "gpu_cull_system.hpp"
+#include "light_buffer.hpp"
+#include "light_cluster_system.hpp"
+#include "image_convert_system.hpp"
+#include "depth_export_system.hpp"
+#include "readback_ring.hpp"
+#include "gpu_profiler.hpp"
+#include "cpu_tracer.hpp"
+#include "mesh_cache.hpp"
+#include "thread_pool.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -20,8 +30,15 @@
 #include <glm/gtc/constants.hpp>
 #include "stb/stb_image.h"
 
+#include <algorithm>
 #include <array>
+#include <iterator>
+#include <future>
+#include <thread>
+#include <unordered_set>
 #include <cassert>
+#include <cstddef>
+#include <cstdio>
 #include <stdexcept>
 #include <chrono>
 #include <nlohmann/json.hpp>
@@ -33,30 +50,63 @@
 
 namespace cvsim {
 
+    namespace {
+        constexpr float CAMERA_NEAR = 0.1f;
+        constexpr float CAMERA_FAR = 100.f;
+
+        // one more than the frames in flight, so the publisher can hold a
+        // frame while the GPU fills the next ones
+        constexpr size_t CAPTURE_RING_SIZE = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+
+        Renderer createRenderer(Window* window, Device& device) {
+            if (window) {
+                return Renderer(*window, device);
+            }
+            return Renderer(device, VkExtent2D{ SimApp::WIDTH, SimApp::HEIGHT });
+        }
+
+        void printMemoryStats(const char* when, const DeviceAllocator::Stats& stats) {
+            constexpr double MB = 1024.0 * 1024.0;
+            std::cout << "[MEM] " << when << ": " << stats.allocationCount << " allocations in "
+                << stats.blockCount << " blocks, " << stats.usedBytes / MB << " / " << stats.blockBytes / MB
+                << " MB used, " << stats.freeRangeCount << " free ranges (largest " << stats.largestFreeRange / MB
+                << " MB, fragmentation " << stats.fragmentation << "), " << stats.dedicatedCount
+                << " dedicated (" << stats.dedicatedBytes / MB << " MB)\n";
+        }
+    }
 
     SimApp::SimApp()
         : SimApp(StressConfig{}) {}   
 
     SimApp::SimApp(const StressConfig& stressCfg)
-        : stressCfg_{ stressCfg } {
+        : stressCfg_{ stressCfg },
+          window{ stressCfg.headless ? nullptr : std::make_unique<Window>(WIDTH, HEIGHT, "CV Sim!") },
+          device{ window.get() },
+          renderer{ createRenderer(window.get(), device) } {
 
         globalPool =
             DescriptorPool::Builder(device)
-            .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT * 10)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT * 6)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SwapChain::MAX_FRAMES_IN_FLIGHT * 12)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SwapChain::MAX_FRAMES_IN_FLIGHT * 2)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT * 10)
+            .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT * 10 * MAX_CAMERA_VIEWS)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT * 6 * MAX_CAMERA_VIEWS)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SwapChain::MAX_FRAMES_IN_FLIGHT * 12 * MAX_CAMERA_VIEWS)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, SwapChain::MAX_FRAMES_IN_FLIGHT * 2 * MAX_CAMERA_VIEWS)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT * 16 * MAX_CAMERA_VIEWS)
             .build();
 
-        scenePass = std::make_unique<enginev::ScenePass>(device);
-        bloomPass = std::make_unique<enginev::BloomPass>(device);
-        lensFlarePass = std::make_unique<LensFlarePass>(device);
-
         createShadowResources();
         createSkyboxCubemap();
 
+        // the spec may replace the scene and stress settings
+        if (!stressCfg_.benchmarkPath.empty()) {
+            benchmark_ = std::make_unique<BenchmarkRun>(
+                BenchmarkSpec::load(stressCfg_.benchmarkPath, stressCfg_),
+                SwapChain::MAX_FRAMES_IN_FLIGHT);
+        }
+
         loadSimObjects();
+        // the skybox goes up with the models, unless there were none
+        uploader_.flush();
+        printMemoryStats("startup", device.getAllocator().getStats());
     }
 
     SimApp::~SimApp() {}
@@ -67,11 +117,129 @@ namespace cvsim {
             return it->second;
         }
 
-        std::shared_ptr<Model> model = {Model::createModelFromFile(device, modelPath)};
+        std::shared_ptr<Model> model = {Model::createModelFromFile(device, modelPath, uploader_)};
+        uploader_.flush();
         modelCache_.emplace(modelPath, model);
         return model;
     }
 
+    void SimApp::loadModels_(const std::vector<std::string>& modelPaths) {
+        std::vector<std::string> pending;
+        std::unordered_set<std::string> seen;
+        for (const auto& modelPath : modelPaths) {
+            if (modelCache_.count(modelPath) == 0 && seen.insert(modelPath).second) {
+                pending.push_back(modelPath);
+            }
+        }
+        if (pending.empty()) {
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // parsing (or mapping the .meshcache) is CPU only; the GPU uploads
+        // stay on this thread, after every model is ready, and go out in
+        // as few submits as the staging ring allows
+        std::vector<std::unique_ptr<LoadedMesh>> meshes;
+        {
+            const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            ThreadPool pool{ std::min(pending.size(), hardwareThreads), "model loader" };
+
+            std::vector<std::future<std::unique_ptr<LoadedMesh>>> loads;
+            loads.reserve(pending.size());
+            for (const auto& modelPath : pending) {
+                loads.push_back(pool.submit([modelPath] { return LoadedMesh::load(modelPath); }));
+            }
+            for (auto& load : loads) {
+                meshes.push_back(load.get());
+            }
+        }
+
+        size_t fromCache = 0;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            fromCache += meshes[i]->isFromCache() ? 1 : 0;
+            modelCache_.emplace(pending[i], std::make_shared<Model>(device, meshes[i]->getMeshData(), uploader_));
+        }
+        uploader_.flush();
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[SCENE] loaded " << pending.size() << " models (" << fromCache << " from .meshcache) in "
+            << ms << " ms\n";
+    }
+
+    void SimApp::streamObject_(const std::string& modelPath, SimObject&& obj) {
+        auto cached = modelCache_.find(modelPath);
+        if (cached != modelCache_.end()) {
+            obj.model = cached->second;
+            sceneStore.add(std::move(obj));
+            return;
+        }
+
+        auto [it, inserted] = streamedModels_.try_emplace(modelPath);
+        if (inserted) {
+            if (!modelLoader_) {
+                // half the cores, the render and ROS threads keep running
+                const unsigned threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+                modelLoader_ = std::make_unique<ThreadPool>(threads, "model loader");
+            }
+            it->second.mesh = modelLoader_->submit([modelPath] { return LoadedMesh::load(modelPath); });
+        }
+        it->second.objects.push_back(std::move(obj));
+    }
+
+    void SimApp::pollStreamedModels_() {
+        if (streamedModels_.empty()) {
+            return;
+        }
+        CpuTracer::Scope trace{ "stream models" };
+
+        bool uploaded = false;
+        for (auto& entry : streamedModels_) {
+            StreamedModel& streamed = entry.second;
+            if (streamed.model ||
+                streamed.mesh.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                continue;
+            }
+            // the geometry is copied into the staging ring here, the
+            // parsed mesh is not needed afterwards
+            streamed.model = std::make_shared<Model>(device, streamed.mesh.get()->getMeshData(), uploader_);
+            uploaded = true;
+        }
+        if (uploaded) {
+            const uint64_t ticket = uploader_.submit();
+            for (auto& entry : streamedModels_) {
+                StreamedModel& streamed = entry.second;
+                if (streamed.model && streamed.uploadTicket == 0) {
+                    streamed.uploadTicket = ticket;
+                }
+            }
+        }
+
+        // resident means acquired by the graphics queue: this frame's
+        // command buffers may draw it
+        const uint64_t completed = uploader_.poll();
+        size_t added = 0;
+        for (auto it = streamedModels_.begin(); it != streamedModels_.end();) {
+            StreamedModel& streamed = it->second;
+            if (!streamed.model || streamed.uploadTicket > completed) {
+                ++it;
+                continue;
+            }
+            for (SimObject& obj : streamed.objects) {
+                obj.model = streamed.model;
+                sceneStore.add(std::move(obj));
+                ++added;
+            }
+            modelCache_.emplace(it->first, streamed.model);
+            it = streamedModels_.erase(it);
+        }
+
+        if (added > 0) {
+            std::cout << "[SCENE] streamed in " << added << " objects, " << streamedModels_.size()
+                << " models still loading\n";
+        }
+    }
+
     void SimApp::destroyShadowResources() {
         if (shadowSampler != VK_NULL_HANDLE) {
             vkDestroySampler(device.device(), shadowSampler, nullptr);
@@ -90,12 +258,7 @@ namespace cvsim {
             shadowImageView = VK_NULL_HANDLE;
         }
         if (shadowImage != VK_NULL_HANDLE) {
-            vkDestroyImage(device.device(), shadowImage, nullptr);
-            shadowImage = VK_NULL_HANDLE;
-        }
-        if (shadowImageMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device.device(), shadowImageMemory, nullptr);
-            shadowImageMemory = VK_NULL_HANDLE;
+            device.destroyImage(shadowImage, shadowImageAllocation);
         }
     }
 
@@ -109,26 +272,40 @@ namespace cvsim {
             skyboxImageView = VK_NULL_HANDLE;
         }
         if (skyboxImage != VK_NULL_HANDLE) {
-            vkDestroyImage(device.device(), skyboxImage, nullptr);
-            skyboxImage = VK_NULL_HANDLE;
-        }
-        if (skyboxImageMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device.device(), skyboxImageMemory, nullptr);
-            skyboxImageMemory = VK_NULL_HANDLE;
+            device.destroyImage(skyboxImage, skyboxImageAllocation);
         }
     }
 
     void SimApp::run() {
-        std::vector<std::unique_ptr<Buffer>> uboBuffers(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        for (int i = 0; i < uboBuffers.size(); i++) {
-            uboBuffers[i] = std::make_unique<Buffer>(
-                device,
-                sizeof(GlobalUbo),
-                1,
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-            uboBuffers[i]->map();
+        const bool tracing = !stressCfg_.tracePath.empty();
+        if (tracing) {
+            CpuTracer::setEnabled(true);
+            CpuTracer::setThreadName("render");
         }
+        auto writeTrace = [this] {
+            if (CpuTracer::writeChromeTrace(stressCfg_.tracePath)) {
+                std::cout << "[TRACE] written to " << stressCfg_.tracePath << std::endl;
+            } else {
+                std::cerr << "[TRACE] failed to write " << stressCfg_.tracePath << "\n";
+            }
+        };
+
+        KeyboardMovementController cameraController{};
+
+        std::vector<CameraRig> cameras;
+        cameras.reserve(3);
+
+        cameras.push_back(CameraRig::MakeCam(glm::vec3(0.f, 0.f, -2.5f), CameraControlType::Keyboard));
+
+        cameras.push_back(CameraRig::MakeCam(glm::vec3(2.f, 1.f, -2.5f), CameraControlType::ROS));
+        cameras.push_back(CameraRig::MakeCam(glm::vec3(2.f, 1.f, -2.5f), CameraControlType::ROS));
+
+        if (cameras.size() > MAX_CAMERA_VIEWS) {
+            throw std::runtime_error("too many cameras for the descriptor pool");
+        }
+        const uint32_t viewCount = static_cast<uint32_t>(cameras.size());
+
+        LightBuffer lightBuffer{ device };
         
         std::vector<LensSurfaceGPU> lensSurfacesCpu = {
             // radius,   z,     ior,  aperture, isStop
@@ -165,49 +342,19 @@ namespace cvsim {
             );
             lensParamsBuffers[i]->map();
         }
-
-        auto exposureData = std::make_unique<Buffer>(
-                    device,
-                    sizeof(float) + sizeof(int),
-                    1,
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-                );
-                exposureData->map();
-
-                // initial data
-                struct {
-                    float logLumSum = 0.0f;
-                    int pixelCount = 0;
-                } expDataInit;
-                exposureData->writeToBuffer(&expDataInit);
-
-                auto exposureState = std::make_unique<Buffer>(
-                    device,
-                    sizeof(float) * 5,
-                    1,
-                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-                );
-                exposureState->map();
-
-                struct {
-                    float autoExposure = 1.0f;
-                    float targetExposure = 1.0f;
-                    float adaptionRateUp = 1.5f;
-                    float adaptionRateDown = 3.5f;
-                    float dt = 0.016f;
-                } expStateInit;
-
-                exposureState->writeToBuffer(&expStateInit);
     
         auto globalSetLayout =
             DescriptorSetLayout::Builder(device)
-            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)
             .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
             .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)  // point lights
+            .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)  // cluster light counts
+            .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)  // cluster light indices
             .build();
 
+        LightClusterSystem lightClusterSystem{ device, globalSetLayout->getDescriptorSetLayout(), viewCount };
+
         auto brightSetLayout =
             DescriptorSetLayout::Builder(device)
             .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
@@ -247,106 +394,140 @@ namespace cvsim {
             .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
             .build();
 
-        std::vector<VkDescriptorSet> globalDescriptorSets(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> brightDescriptorSets(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> blurDescriptorSetsH(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> blurDescriptorSetsV(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> lensDescriptorSets(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> exposureReduceDescriptorSet(SwapChain::MAX_FRAMES_IN_FLIGHT);
-        std::vector<VkDescriptorSet> exposureUpdateDescriptorSet(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        auto extent = renderer.getSwapChainExtent();
 
-        VkDescriptorImageInfo hdrImageInfo{};
-        hdrImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        hdrImageInfo.imageView = scenePass->getColorView();
-        hdrImageInfo.sampler = scenePass->getColorSampler();
+        ImageEncoding imageEncoding = ImageEncoding::BGRA8;
+        if (!ImageConvertSystem::parseEncoding(stressCfg_.imageEncoding, imageEncoding)) {
+            throw std::runtime_error("unknown image encoding: " + stressCfg_.imageEncoding);
+        }
 
-        auto expDataInfo = exposureData->descriptorInfo();
-        auto expStateInfo = exposureState->descriptorInfo();
+        // full-size bgra8 is the layout of the rendered image and is copied
+        // as is; anything else is packed on the GPU before readback
+        std::unique_ptr<ImageConvertSystem> imageConvertSystem;
+        if (imageEncoding != ImageEncoding::BGRA8 || stressCfg_.outputWidth > 0) {
+            imageConvertSystem = std::make_unique<ImageConvertSystem>(device, imageEncoding, viewCount);
+        }
 
-        VkDescriptorSet exposureReduceSet;
-        DescriptorWriter(*exposureReduceLayout, *globalPool)
-        .writeImage(0, &hdrImageInfo)
-        .writeBuffer(1, &expDataInfo)
-        .build(exposureReduceSet);
+        std::unique_ptr<DepthExportSystem> depthExportSystem;
+        if (!stressCfg_.depthEncoding.empty()) {
+            DepthEncoding depthEncoding = DepthEncoding::FLOAT32;
+            if (!DepthExportSystem::parseEncoding(stressCfg_.depthEncoding, depthEncoding)) {
+                throw std::runtime_error("unknown depth encoding: " + stressCfg_.depthEncoding);
+            }
+            depthExportSystem = std::make_unique<DepthExportSystem>(device, depthEncoding, viewCount);
+        }
 
-        VkDescriptorSet exposureUpdateSet;
-        DescriptorWriter(*exposureUpdateLayout, *globalPool)
-        .writeBuffer(0, &expDataInfo)
-        .writeBuffer(1, &expStateInfo)
-        .build(exposureUpdateSet);
+        const bool labelOutput = !stressCfg_.labelMode.empty();
+        if (stressCfg_.labelMode == "semantic") {
+            sceneStore.setLabelMode(SceneStore::LabelMode::Semantic);
+        } else if (labelOutput && stressCfg_.labelMode != "instance") {
+            throw std::runtime_error("unknown label mode: " + stressCfg_.labelMode);
+        }
 
-        postDescriptorSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        RosImageBridge ros;
 
-        auto extent = renderer.getSwapChainExtent();
-        scenePass->recreate(extent);
-        bloomPass->recreate(extent, 0.5f);
-        lensFlarePass->recreate(renderer.getSwapChainExtent(), 1.0f);
-
-        VkDescriptorImageInfo sceneColorInfo{};
-        sceneColorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        sceneColorInfo.imageView   = scenePass->getColorView();     
-        sceneColorInfo.sampler     = scenePass->getColorSampler();
-
-        VkDescriptorImageInfo bloomAInfo{};
-        bloomAInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        bloomAInfo.imageView   = bloomPass->getViewA();
-        bloomAInfo.sampler     = bloomPass->getSamplerA();
-
-        VkDescriptorImageInfo bloomBInfo{};
-        bloomBInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        bloomBInfo.imageView   = bloomPass->getViewB();
-        bloomBInfo.sampler     = bloomPass->getSamplerB();
-
-        VkDescriptorImageInfo sceneDepthInfo{};
-        sceneDepthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-        sceneDepthInfo.imageView = scenePass->getDepthView();
-        sceneDepthInfo.sampler = scenePass->getDepthSampler();
-
-        VkDescriptorImageInfo flareSampledInfo{};
-        flareSampledInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        flareSampledInfo.imageView = lensFlarePass->getFlareView();
-        flareSampledInfo.sampler = lensFlarePass->getFlareSampler();
-
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-            DescriptorWriter(*brightSetLayout, *globalPool)
-                .writeImage(0, &sceneColorInfo)
-                .build(brightDescriptorSets[i]);
+        int activeCam = 0;
+        if (!window && !benchmark_) {
+            // nothing to steer with a keyboard: drive the first ROS camera
+            for (size_t i = 0; i < cameras.size(); ++i) {
+                if (cameras[i].control == CameraControlType::ROS) {
+                    activeCam = static_cast<int>(i);
+                    break;
+                }
+            }
         }
 
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-            DescriptorWriter(*blurSetLayout, *globalPool)
-                .writeImage(0, &bloomAInfo)
-                .build(blurDescriptorSetsH[i]);
+        // a view drawn into the swap chain for the whole run never renders
+        // into its own target; with a window, C can move any view off it
+        auto needsTarget = [&](uint32_t v) {
+            const bool alwaysShown = static_cast<int>(v) == activeCam && (!window || viewCount == 1);
+            return imageConvertSystem || !alwaysShown;
+        };
 
-            DescriptorWriter(*blurSetLayout, *globalPool)
-                .writeImage(0, &bloomBInfo)
-                .build(blurDescriptorSetsV[i]);
-        }
+        // every camera gets its own targets, uniforms, exposure state and
+        // topic; shadow map, lights and object data are shared
+        std::vector<CameraView> views(viewCount);
+        for (uint32_t v = 0; v < viewCount; ++v) {
+            CameraView& view = views[v];
+
+            view.scenePass = std::make_unique<enginev::ScenePass>(device, labelOutput);
+            view.bloomPass = std::make_unique<enginev::BloomPass>(device);
+            view.lensFlarePass = std::make_unique<LensFlarePass>(device);
+            view.scenePass->recreate(extent);
+            view.bloomPass->recreate(extent, 0.5f);
+            view.lensFlarePass->recreate(extent, 1.0f);
+            if (needsTarget(v)) {
+                view.target = std::make_unique<OffscreenTarget>(device, extent);
+            }
 
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-            auto bufferInfo = uboBuffers[i]->descriptorInfo();
+            view.uboBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+            for (auto& uboBuffer : view.uboBuffers) {
+                uboBuffer = std::make_unique<Buffer>(
+                    device,
+                    sizeof(GlobalUbo),
+                    1,
+                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+                uboBuffer->map();
+            }
 
-            enginev::DescriptorWriter(*postSetLayout, *globalPool)
-                .writeImage(0, &sceneColorInfo)
-                .writeImage(1, &bloomAInfo)
-                .writeBuffer(2, &bufferInfo)
-                .writeImage(3, &sceneDepthInfo)
-                .writeImage(4, &flareSampledInfo)
-                .build(postDescriptorSets[i]);
-        }
+            view.exposureData = std::make_unique<Buffer>(
+                device,
+                sizeof(float) + sizeof(int),
+                1,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            );
+            view.exposureData->map();
 
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-            DescriptorWriter(*exposureReduceLayout, *globalPool)
-                .writeImage(0, &hdrImageInfo)
-                .writeBuffer(1, &expDataInfo)
-                .build(exposureReduceDescriptorSet[i]);
-        }
+            // initial data
+            struct {
+                float logLumSum = 0.0f;
+                int pixelCount = 0;
+            } expDataInit;
+            view.exposureData->writeToBuffer(&expDataInit);
 
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-            DescriptorWriter(*exposureUpdateLayout, *globalPool)
-                .writeBuffer(0, &expDataInfo)
-                .writeBuffer(1, &expStateInfo)
-                .build(exposureUpdateDescriptorSet[i]);
+            view.exposureState = std::make_unique<Buffer>(
+                device,
+                sizeof(float) * 5,
+                1,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            );
+            view.exposureState->map();
+
+            struct {
+                float autoExposure = 1.0f;
+                float targetExposure = 1.0f;
+                float adaptionRateUp = 1.5f;
+                float adaptionRateDown = 3.5f;
+                float dt = 0.016f;
+            } expStateInit;
+
+            view.exposureState->writeToBuffer(&expStateInit);
+
+            view.globalSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.brightSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.blurSetsH.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.blurSetsV.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.postSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.lensSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.exposureReduceSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            view.exposureUpdateSets.resize(SwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+
+            // the first camera keeps the original topic
+            const std::string topicPrefix = v == 0 ? "/sim" : "/sim/camera_" + std::to_string(v);
+            const std::string frameId = v == 0 ? "sim_camera" : "sim_camera_" + std::to_string(v);
+            view.publisher = v == 0 ? 0 : ros.addImagePublisher(topicPrefix + "/image", frameId);
+            if (cameras[v].control == CameraControlType::ROS && v != 0) {
+                cameras[v].cmdSubscription = ros.addCommandSubscription(topicPrefix + "/camera_cmd");
+            }
+            if (depthExportSystem) {
+                view.depthPublisher = ros.addImagePublisher(topicPrefix + "/depth", frameId);
+            }
+            if (labelOutput) {
+                view.labelPublisher = ros.addImagePublisher(topicPrefix + "/labels", frameId);
+            }
         }
 
         VkDescriptorImageInfo shadowImageInfo{};
@@ -359,39 +540,124 @@ namespace cvsim {
         skyboxImageInfo.imageView = skyboxImageView;
         skyboxImageInfo.sampler = skyboxSampler;
 
-        for (int i = 0; i < globalDescriptorSets.size(); i++) {
-            auto bufferInfo = uboBuffers[i]->descriptorInfo();
+        // allocates the set on first use; later calls (after a resize, when
+        // no frame is in flight) rewrite it in place
+        auto writeSet = [](DescriptorWriter& writer, VkDescriptorSet& set) {
+            if (set == VK_NULL_HANDLE) {
+                if (!writer.build(set)) {
+                    throw std::runtime_error("failed to allocate descriptor set");
+                }
+            } else {
+                writer.overwrite(set);
+            }
+        };
 
-            DescriptorWriter(*globalSetLayout, *globalPool)
-                .writeBuffer(0, &bufferInfo)     
-                .writeImage(1, &shadowImageInfo) 
-                .writeImage(2, &skyboxImageInfo)
-                .build(globalDescriptorSets[i]);
-        }
+        auto writeViewDescriptors = [&](CameraView& view, uint32_t viewIndex) {
+            VkDescriptorImageInfo sceneColorInfo{};
+            sceneColorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            sceneColorInfo.imageView   = view.scenePass->getColorView();
+            sceneColorInfo.sampler     = view.scenePass->getColorSampler();
 
-        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
+            VkDescriptorImageInfo bloomAInfo{};
+            bloomAInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            bloomAInfo.imageView   = view.bloomPass->getViewA();
+            bloomAInfo.sampler     = view.bloomPass->getSamplerA();
+
+            VkDescriptorImageInfo bloomBInfo{};
+            bloomBInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            bloomBInfo.imageView   = view.bloomPass->getViewB();
+            bloomBInfo.sampler     = view.bloomPass->getSamplerB();
+
+            VkDescriptorImageInfo sceneDepthInfo{};
+            sceneDepthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            sceneDepthInfo.imageView = view.scenePass->getDepthView();
+            sceneDepthInfo.sampler = view.scenePass->getDepthSampler();
+
+            VkDescriptorImageInfo flareSampledInfo{};
+            flareSampledInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            flareSampledInfo.imageView = view.lensFlarePass->getFlareView();
+            flareSampledInfo.sampler = view.lensFlarePass->getFlareSampler();
 
             VkDescriptorImageInfo flareStorageInfo{};
             flareStorageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-            flareStorageInfo.imageView   = lensFlarePass->getFlareView();
+            flareStorageInfo.imageView   = view.lensFlarePass->getFlareView();
             flareStorageInfo.sampler     = VK_NULL_HANDLE; // storage image
 
-            auto lensSurfInfo   = lensSurfacesBuffer->descriptorInfo();
-            auto lensParamsInfo = lensParamsBuffers[i]->descriptorInfo();
-            auto globalInfo     = uboBuffers[i]->descriptorInfo();
+            auto expDataInfo = view.exposureData->descriptorInfo();
+            auto expStateInfo = view.exposureState->descriptorInfo();
+            auto lensSurfInfo = lensSurfacesBuffer->descriptorInfo();
+
+            for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
+                auto bufferInfo = view.uboBuffers[i]->descriptorInfo();
+                auto lightInfo = lightBuffer.descriptorInfo(i);
+                auto clusterCountsInfo = lightClusterSystem.countsInfo(i, viewIndex);
+                auto clusterLightsInfo = lightClusterSystem.lightIndicesInfo(i, viewIndex);
+                auto lensParamsInfo = lensParamsBuffers[i]->descriptorInfo();
+
+                DescriptorWriter globalWriter(*globalSetLayout, *globalPool);
+                globalWriter
+                    .writeBuffer(0, &bufferInfo)
+                    .writeImage(1, &shadowImageInfo)
+                    .writeImage(2, &skyboxImageInfo)
+                    .writeBuffer(3, &lightInfo)
+                    .writeBuffer(4, &clusterCountsInfo)
+                    .writeBuffer(5, &clusterLightsInfo);
+                writeSet(globalWriter, view.globalSets[i]);
+
+                DescriptorWriter brightWriter(*brightSetLayout, *globalPool);
+                brightWriter.writeImage(0, &sceneColorInfo);
+                writeSet(brightWriter, view.brightSets[i]);
+
+                DescriptorWriter blurHWriter(*blurSetLayout, *globalPool);
+                blurHWriter.writeImage(0, &bloomAInfo);
+                writeSet(blurHWriter, view.blurSetsH[i]);
+
+                DescriptorWriter blurVWriter(*blurSetLayout, *globalPool);
+                blurVWriter.writeImage(0, &bloomBInfo);
+                writeSet(blurVWriter, view.blurSetsV[i]);
+
+                DescriptorWriter postWriter(*postSetLayout, *globalPool);
+                postWriter
+                    .writeImage(0, &sceneColorInfo)
+                    .writeImage(1, &bloomAInfo)
+                    .writeBuffer(2, &bufferInfo)
+                    .writeImage(3, &sceneDepthInfo)
+                    .writeImage(4, &flareSampledInfo);
+                writeSet(postWriter, view.postSets[i]);
+
+                DescriptorWriter lensWriter(*lensSetLayout, *globalPool);
+                lensWriter
+                    .writeImage(0, &flareStorageInfo)
+                    .writeBuffer(1, &lensSurfInfo)
+                    .writeBuffer(2, &lensParamsInfo)
+                    .writeBuffer(3, &bufferInfo);
+                writeSet(lensWriter, view.lensSets[i]);
+
+                DescriptorWriter exposureReduceWriter(*exposureReduceLayout, *globalPool);
+                exposureReduceWriter
+                    .writeImage(0, &sceneColorInfo)
+                    .writeBuffer(1, &expDataInfo);
+                writeSet(exposureReduceWriter, view.exposureReduceSets[i]);
+
+                DescriptorWriter exposureUpdateWriter(*exposureUpdateLayout, *globalPool);
+                exposureUpdateWriter
+                    .writeBuffer(0, &expDataInfo)
+                    .writeBuffer(1, &expStateInfo);
+                writeSet(exposureUpdateWriter, view.exposureUpdateSets[i]);
+            }
+        };
 
-            DescriptorWriter(*lensSetLayout, *globalPool)
-                .writeImage(0, &flareStorageInfo)
-                .writeBuffer(1, &lensSurfInfo)
-                .writeBuffer(2, &lensParamsInfo)
-                .writeBuffer(3, &globalInfo)
-                .build(lensDescriptorSets[i]);
+        for (uint32_t v = 0; v < viewCount; ++v) {
+            writeViewDescriptors(views[v], v);
         }
 
+        // all views share the scene pass and bloom layouts, so pipelines
+        // built against the first view's passes work for every view
         SimpleRenderSystem simpleRenderSystem{
             device,
-            scenePass->getRenderPass(),
-            globalSetLayout->getDescriptorSetLayout() };
+            views[0].scenePass->getRenderPass(),
+            globalSetLayout->getDescriptorSetLayout(),
+            labelOutput };
             
         ShadowRenderSystem shadowRenderSystem{
             device,
@@ -399,98 +665,144 @@ namespace cvsim {
             globalSetLayout->getDescriptorSetLayout() };
         PointLightSystem pointLightSystem{
            device,
-           scenePass->getRenderPass(),
-           globalSetLayout->getDescriptorSetLayout() };
+           views[0].scenePass->getRenderPass(),
+           globalSetLayout->getDescriptorSetLayout(),
+           labelOutput };
+
+        simpleRenderSystem.setInstancingEnabled(stressCfg_.instancing);
+        simpleRenderSystem.setClusteredLighting(stressCfg_.clusteredLighting);
+        shadowRenderSystem.setInstancingEnabled(stressCfg_.instancing);
+
+        std::unique_ptr<GpuCullSystem> gpuCullSystem;
+        if (stressCfg_.gpuCulling) {
+            gpuCullSystem = std::make_unique<GpuCullSystem>(
+                device, globalSetLayout->getDescriptorSetLayout(), viewCount);
+            simpleRenderSystem.setGpuCullSystem(gpuCullSystem.get());
+        }
 
         SkyboxRenderSystem skyboxRenderSystem(
             device,
-            scenePass->getRenderPass(),
-            globalSetLayout->getDescriptorSetLayout()
+            uploader_,
+            views[0].scenePass->getRenderPass(),
+            globalSetLayout->getDescriptorSetLayout(),
+            labelOutput
         );
 
         BrightExtractRenderSystem brightExtractSystem(
             device,
-            bloomPass->getRenderPass(),
+            views[0].bloomPass->getRenderPass(),
             brightSetLayout->getDescriptorSetLayout()
         );
 
         BlurRenderSystem blurHSystem(
             device,
-            bloomPass->getRenderPass(),
+            views[0].bloomPass->getRenderPass(),
             blurSetLayout->getDescriptorSetLayout(),
             true
         );
 
         BlurRenderSystem blurVSystem(
             device,
-            bloomPass->getRenderPass(),
+            views[0].bloomPass->getRenderPass(),
             blurSetLayout->getDescriptorSetLayout(),
             false
         );
 
+        // the camera shown in the window is post-processed into the swap
+        // chain (or the headless target), the others into their own targets
         PostProcessRenderSystem postProcessSystem(
             device,
             renderer.getSwapChainRenderPass(),
             postSetLayout->getDescriptorSetLayout()
         );
 
+        std::unique_ptr<PostProcessRenderSystem> viewPostProcessSystem;
+        for (CameraView& view : views) {
+            if (view.target) {
+                viewPostProcessSystem = std::make_unique<PostProcessRenderSystem>(
+                    device,
+                    view.target->getRenderPass(),
+                    postSetLayout->getDescriptorSetLayout()
+                );
+                break;
+            }
+        }
+
         ExposureReduceSystem exposureReduceSystem(device);
         ExposureUpdateSystem exposureUpdateSystem(device);
 
-        std::shared_ptr<Model> skyboxModel = Model::createSkyboxCube(device);
-        
-        KeyboardMovementController cameraController{};
-
-        std::vector<CameraRig> cameras;
-        cameras.reserve(3);
-
-        cameras.push_back(CameraRig::MakeCam(glm::vec3(0.f, 0.f, -2.5f), CameraControlType::Keyboard));
-
-        cameras.push_back(CameraRig::MakeCam(glm::vec3(2.f, 1.f, -2.5f), CameraControlType::ROS));
-        cameras.push_back(CameraRig::MakeCam(glm::vec3(2.f, 1.f, -2.5f), CameraControlType::ROS));
-
-        int activeCam = 0;
+        std::shared_ptr<Model> skyboxModel = Model::createSkyboxCube(device, uploader_);
+        // the skybox meshes go up together
+        uploader_.flush();
 
         auto currentTime = std::chrono::high_resolution_clock::now();
 
-        struct FrameCapture { VkBuffer buf{}; VkDeviceMemory mem{}; void* mapped{}; size_t size{}; };
-        std::array<FrameCapture, enginev::SwapChain::MAX_FRAMES_IN_FLIGHT> captures;
-        
-        RosImageBridge ros;
-
-        auto recreateCaptures = [&]() {
-            for (auto &c : captures) {
-                if (c.mapped) {
-                    vkUnmapMemory(device.device(), c.mem);
-                    c.mapped = nullptr;
-                }
-                if (c.buf) {
-                    vkDestroyBuffer(device.device(), c.buf, nullptr);
-                    c.buf = VK_NULL_HANDLE;
-                }
-                if (c.mem) {
-                    vkFreeMemory(device.device(), c.mem, nullptr);
-                    c.mem = VK_NULL_HANDLE;
-                }
+        // frames are published from the rings' worker threads once their
+        // copy has completed on the GPU
+        const std::string encodingName = ImageConvertSystem::encodingName(imageEncoding);
+        const uint32_t bytesPerPixel = ImageConvertSystem::bytesPerPixel(imageEncoding);
+        BenchmarkRun* benchmark = benchmark_.get();
+        for (auto& view : views) {
+            const size_t publisher = view.publisher;
+            view.captureRing = std::make_unique<ReadbackRing>(
+                device,
+                CAPTURE_RING_SIZE,
+                [&ros, publisher, encodingName, bytesPerPixel, benchmark](const ReadbackRing::Frame& frame) {
+                    if (benchmark) {
+                        // submit of the frame -> its pixels are readable
+                        const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+                        benchmark->addReadbackLatency(static_cast<double>(nowNs - frame.captureTimeNs) * 1e-6);
+                    }
+                    const uint32_t step = frame.width * bytesPerPixel;
+                    ros.publishImage(
+                        publisher, encodingName, frame.width, frame.height, step,
+                        frame.data, static_cast<size_t>(step) * frame.height,
+                        rclcpp::Time(frame.captureTimeNs, RCL_SYSTEM_TIME));
+                });
+
+            if (depthExportSystem) {
+                const size_t depthPublisher = view.depthPublisher;
+                const std::string depthEncodingName =
+                    DepthExportSystem::encodingName(depthExportSystem->getEncoding());
+                const uint32_t depthBytesPerPixel =
+                    DepthExportSystem::bytesPerPixel(depthExportSystem->getEncoding());
+
+                view.depthRing = std::make_unique<ReadbackRing>(
+                    device,
+                    CAPTURE_RING_SIZE,
+                    [&ros, depthPublisher, depthEncodingName, depthBytesPerPixel](const ReadbackRing::Frame& frame) {
+                        const uint32_t step = frame.width * depthBytesPerPixel;
+                        ros.publishImage(
+                            depthPublisher, depthEncodingName, frame.width, frame.height, step,
+                            frame.data, static_cast<size_t>(step) * frame.height,
+                            rclcpp::Time(frame.captureTimeNs, RCL_SYSTEM_TIME));
+                    });
             }
 
-            extent = renderer.getSwapChainExtent();
-            const size_t byteSize = extent.width * extent.height * 4; 
-            
-            for (size_t i = 0; i < captures.size(); ++i) {
-                VkBuffer buf; VkDeviceMemory mem;
-                device.createBuffer(
-                    byteSize,
-                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    buf, mem);
-                void* ptr = nullptr;
-                vkMapMemory(device.device(), mem, 0, VK_WHOLE_SIZE, 0, &ptr);
-                captures[i] = FrameCapture{ buf, mem, ptr, byteSize };
+            if (labelOutput) {
+                // labels are never resampled, so they stay at the render
+                // resolution
+                const size_t labelPublisher = view.labelPublisher;
+                view.labelRing = std::make_unique<ReadbackRing>(
+                    device,
+                    CAPTURE_RING_SIZE,
+                    [&ros, labelPublisher](const ReadbackRing::Frame& frame) {
+                        const uint32_t step = frame.width * sizeof(uint32_t);
+                        ros.publishImage(
+                            labelPublisher, "32SC1", frame.width, frame.height, step,
+                            frame.data, static_cast<size_t>(step) * frame.height,
+                            rclcpp::Time(frame.captureTimeNs, RCL_SYSTEM_TIME));
+                    });
             }
-        };
+        }
 
-        recreateCaptures();
+        std::vector<ReadbackRing::Slot*> captures(viewCount, nullptr);
+        std::vector<ReadbackRing::Slot*> depthCaptures(viewCount, nullptr);
+        std::vector<ReadbackRing::Slot*> labelCaptures(viewCount, nullptr);
+        std::vector<GlobalUbo> viewUbos(viewCount);
+        std::vector<FrameInfo> frameInfos;
+        frameInfos.reserve(viewCount);
 
         double fpsWindowTime = 0.0;
         std::uint64_t fpsWindowFrames = 0;
@@ -500,41 +812,111 @@ namespace cvsim {
 
         const double fpsPrintPeriod = 1.0;
 
-        while (!window.shouldClose()) {
-            glfwPollEvents();
+        // receive time -> submission of the first frame rendered with it
+        uint64_t sharedCmdSequence = 0;
+        std::vector<int64_t> freshCmdTimes;
+        double cmdLatencySum = 0.0;
+        std::uint64_t cmdLatencyCount = 0;
+
+        BenchmarkRun::FrameStats benchStats{};
+
+        GpuProfiler gpuProfiler{ device };
+        if ((stressCfg_.gpuProfile || benchmark) && !gpuProfiler.enable()) {
+            std::cerr << "[PROFILE] graphics queue has no timestamps, GPU frame and stage times are not reported\n";
+        }
+
+        struct ViewScopes {
+            uint32_t cull, clusters, scene, labels, depth, bloom, lensFlare, exposure, post, copy;
+        };
+        const uint32_t shadowScope = gpuProfiler.registerScope("shadow");
+        std::vector<ViewScopes> viewScopes(viewCount);
+        for (uint32_t v = 0; v < viewCount; ++v) {
+            const std::string prefix = "cam" + std::to_string(v) + "/";
+            viewScopes[v] = {
+                gpuProfiler.registerScope(prefix + "cull"),
+                gpuProfiler.registerScope(prefix + "clusters"),
+                gpuProfiler.registerScope(prefix + "scene"),
+                gpuProfiler.registerScope(prefix + "labels"),
+                gpuProfiler.registerScope(prefix + "depth"),
+                gpuProfiler.registerScope(prefix + "bloom"),
+                gpuProfiler.registerScope(prefix + "lens_flare"),
+                gpuProfiler.registerScope(prefix + "exposure"),
+                gpuProfiler.registerScope(prefix + "post"),
+                gpuProfiler.registerScope(prefix + "copy"),
+            };
+        }
+        uint64_t lastProfiledFrame = 0;
+
+        // headless runs until the ROS context shuts down (e.g. SIGINT)
+        while (window ? !window->shouldClose() : rclcpp::ok()) {
+            CpuTracer::Scope frameTrace{ "frame" };
 
-            static bool cWasPressed = false;
-            bool cPressed = glfwGetKey(window.getGLFWwindow(), GLFW_KEY_C) == GLFW_PRESS;
+            bool dumpTrace = false;
+            if (window) {
+                CpuTracer::Scope trace{ "poll input" };
+                glfwPollEvents();
 
-            if (cPressed && !cWasPressed) {
-                activeCam = (activeCam + 1) % static_cast<int>(cameras.size());
+                static bool cWasPressed = false;
+                bool cPressed = glfwGetKey(window->getGLFWwindow(), GLFW_KEY_C) == GLFW_PRESS;
+
+                if (cPressed && !cWasPressed) {
+                    activeCam = (activeCam + 1) % static_cast<int>(cameras.size());
+                }
+                cWasPressed = cPressed;
+
+                // T writes the trace recorded so far
+                static bool tWasPressed = false;
+                bool tPressed = glfwGetKey(window->getGLFWwindow(), GLFW_KEY_T) == GLFW_PRESS;
+                dumpTrace = tracing && tPressed && !tWasPressed;
+                tWasPressed = tPressed;
+            }
+            if (dumpTrace) {
+                writeTrace();
             }
-            cWasPressed = cPressed;
 
             auto newTime = std::chrono::high_resolution_clock::now();
             float frameTime =
                 std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
             currentTime = newTime;
-
-            auto cmd = ros.getLastCmd();
+            // a benchmark simulates with a fixed step, so every run renders
+            // the same frames; frameTime stays the measured one
+            const float simDt = benchmark ? benchmark->getSpec().dt : frameTime;
+
+            // /sim/camera_cmd steers the active camera, a ROS camera's own
+            // topic steers it whether it is active or not
+            const CameraCommand cmd = ros.getLastCmd();
+            freshCmdTimes.clear();
             
             for (size_t i = 0; i < cameras.size(); ++i)
             {
+                CpuTracer::Scope trace{ "camera update", static_cast<int64_t>(i) };
                 auto& cam = cameras[i];
 
-                if (static_cast<int>(i) == activeCam)
+                if (benchmark && i == 0) {
+                    benchmark->cameraPose(cam.rig.transform.translation, cam.rig.transform.rotation);
+                }
+                else if (static_cast<int>(i) == activeCam)
                 {
-                    if (cam.control == CameraControlType::Keyboard) {
+                    if (window) {
                         cameraController.moveInPlaneXZ(
-                            window.getGLFWwindow(), frameTime, cam.rig
+                            window->getGLFWwindow(), simDt, cam.rig
                         );
-                    } else {
+                    }
+                    if (cam.control == CameraControlType::ROS) {
+                        cam.applyRos(simDt, cmd);
+                        if (cmd.sequence != sharedCmdSequence) {
+                            sharedCmdSequence = cmd.sequence;
+                            freshCmdTimes.push_back(cmd.receiveTimeNs);
+                        }
+                    }
+                }
 
-                            cameraController.moveInPlaneXZ(
-                                window.getGLFWwindow(), frameTime, cam.rig
-                            );
-                            cam.applyRos(frameTime, cmd);
-                        
+                if (cam.control == CameraControlType::ROS && cam.cmdSubscription != 0) {
+                    const CameraCommand ownCmd = ros.getLastCmd(cam.cmdSubscription);
+                    cam.applyRos(simDt, ownCmd);
+                    if (ownCmd.sequence != cam.lastCmdSequence) {
+                        cam.lastCmdSequence = ownCmd.sequence;
+                        freshCmdTimes.push_back(ownCmd.receiveTimeNs);
                     }
                 }
 
@@ -543,15 +925,33 @@ namespace cvsim {
 
             float aspect = renderer.getAspectRatio();
             for (auto& cam : cameras) {
-                cam.camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+                cam.camera.setPerspectiveProjection(glm::radians(50.f), aspect, CAMERA_NEAR, CAMERA_FAR);
             }
 
-            enginev::Camera& camera = cameras[activeCam].camera;
-            glm::mat4 VP = camera.getProjection() * camera.getView();
-            Frustum frustum = extractFrustum(VP);
+            pollStreamedModels_();
+
+            const std::vector<uint32_t>& changedSlots = sceneStore.flushTransforms();
+            sceneBvh.update(changedSlots);
 
             if (auto commandBuffer = renderer.beginFrame()) {
                 int frameIndex = renderer.getFrameIndex();
+                gpuProfiler.beginFrame(commandBuffer, frameIndex, renderer.getFrameNumber());
+
+                if (benchmark) {
+                    const GpuProfiler::FrameTimings& scopeTimes = gpuProfiler.getLastFrame();
+                    if (scopeTimes.frameNumber != lastProfiledFrame) {
+                        lastProfiledFrame = scopeTimes.frameNumber;
+                        for (const auto& [scope, milliseconds] : scopeTimes.scopes) {
+                            if (scope == GpuProfiler::FRAME_SCOPE) {
+                                benchmark->addGpuFrameTime(scopeTimes.frameNumber, milliseconds);
+                            } else {
+                                benchmark->addGpuScopeTime(
+                                    scopeTimes.frameNumber, gpuProfiler.scopeName(scope), milliseconds);
+                            }
+                        }
+                    }
+                    benchStats = {};
+                }
 
                 VkExtent2D newExtent = renderer.getSwapChainExtent();
 
@@ -559,152 +959,35 @@ namespace cvsim {
                 newExtent.height != extent.height) {
                     vkDeviceWaitIdle(device.device());
                     extent = newExtent;
-                    recreateCaptures();
-
-                    scenePass->recreate(extent);
-                    bloomPass->recreate(extent, 0.5f);
-                    lensFlarePass->recreate(renderer.getSwapChainExtent(), 1.0f);
-
-                    VkDescriptorImageInfo sceneColorInfo{};
-                    sceneColorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    sceneColorInfo.imageView   = scenePass->getColorView();
-                    sceneColorInfo.sampler     = scenePass->getColorSampler();
-
-                    VkDescriptorImageInfo bloomAInfo{};
-                    bloomAInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    bloomAInfo.imageView   = bloomPass->getViewA();
-                    bloomAInfo.sampler     = bloomPass->getSamplerA();
-
-                    VkDescriptorImageInfo bloomBInfo{};
-                    bloomBInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    bloomBInfo.imageView   = bloomPass->getViewB();
-                    bloomBInfo.sampler     = bloomPass->getSamplerB();
-
-                    VkDescriptorImageInfo sceneDepthInfo{};
-                    sceneDepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    sceneDepthInfo.imageView = scenePass->getDepthView();
-                    sceneDepthInfo.sampler = scenePass->getDepthSampler();
-
-                    VkDescriptorImageInfo flareSampledInfo{};
-                    flareSampledInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    flareSampledInfo.imageView   = lensFlarePass->getFlareView();
-                    flareSampledInfo.sampler     = lensFlarePass->getFlareSampler();
-
-                    for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-                        DescriptorWriter(*brightSetLayout, *globalPool)
-                            .writeImage(0, &sceneColorInfo)
-                            .build(brightDescriptorSets[i]);
-                    }
-
-                     for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-                        DescriptorWriter(*blurSetLayout, *globalPool)
-                            .writeImage(0, &bloomAInfo)
-                            .build(blurDescriptorSetsH[i]);
 
-                        DescriptorWriter(*blurSetLayout, *globalPool)
-                            .writeImage(0, &bloomBInfo)
-                            .build(blurDescriptorSetsV[i]);
-                            }
-
-                    for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-                        auto bufferInfo = uboBuffers[i]->descriptorInfo();
-
-                        DescriptorWriter(*postSetLayout, *globalPool)
-                            .writeImage(0, &sceneColorInfo)
-                            .writeImage(1, &bloomAInfo)
-                            .writeBuffer(2, &bufferInfo)
-                            .writeImage(3, &sceneDepthInfo)
-                            .writeImage(4, &flareSampledInfo)
-                            .build(postDescriptorSets[i]);
-                    }
-
-                    for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
-                        VkDescriptorImageInfo flareStorageInfo{};
-                        flareStorageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-                        flareStorageInfo.imageView   = lensFlarePass->getFlareView();
-                        flareStorageInfo.sampler     = VK_NULL_HANDLE;
-
-                        auto lensSurfInfo   = lensSurfacesBuffer->descriptorInfo();
-                        auto lensParamsInfo = lensParamsBuffers[i]->descriptorInfo();
-                        auto globalInfo     = uboBuffers[i]->descriptorInfo();
-
-                        DescriptorWriter(*lensSetLayout, *globalPool)
-                            .writeImage(0, &flareStorageInfo)
-                            .writeBuffer(1, &lensSurfInfo)
-                            .writeBuffer(2, &lensParamsInfo)
-                            .writeBuffer(3, &globalInfo)
-                            .build(lensDescriptorSets[i]);
+                    for (uint32_t v = 0; v < viewCount; ++v) {
+                        CameraView& view = views[v];
+                        view.scenePass->recreate(extent);
+                        view.bloomPass->recreate(extent, 0.5f);
+                        view.lensFlarePass->recreate(extent, 1.0f);
+                        if (view.target) {
+                            view.target = std::make_unique<OffscreenTarget>(device, extent);
+                        }
+                        writeViewDescriptors(view, v);
                     }
                 }
-                FrameInfo frameInfo{ 
-                    frameIndex, 
-                    frameTime, 
-                    commandBuffer, 
-                    camera,
-                    globalDescriptorSets[frameIndex], 
-                    simObjects};
-                
-                frameInfo.frustum = frustum;
-                GlobalUbo ubo{};
-                ubo.projection = camera.getProjection();
-                ubo.view = camera.getView();
-                ubo.inverseView = glm::inverse(camera.getView());
-
-                glm::mat4 invView = ubo.inverseView;
-
-                glm::mat4 V = camera.getView();
-                glm::mat4 P = camera.getProjection();
-                glm::mat4 invV = glm::inverse(V);
-
-                glm::vec3 camPos = glm::vec3(invV[3]);
-                glm::vec3 camForward = glm::normalize(-glm::vec3(invV[2]));
-
-                glm::vec3 sunWorld = camPos + (-lightDir) * 10000.0f;
-                glm::vec3 sunWorldInv = camPos + (lightDir) * 10000.0f;
-                glm::vec3 sunViewDir = glm::normalize(sunWorldInv - camPos);
-                float dotFS = glm::clamp(glm::dot(camForward, sunViewDir), 0.0f, 1.0f);
-                float sunFactor = glm::smoothstep(0.70f, 0.95f, dotFS);
-
-                ubo.sunParams = glm::vec4(sunFactor, 0.f, 0.f, 0.f);
-
 
-                glm::vec4 clip = P * V * glm::vec4(sunWorld, 1.0f);
-
-                glm::vec2 sunUV(0.5f);
-                float visibility = 0.0f;
-
-                if (clip.w > 0.0f) {
-                    glm::vec3 ndc = glm::vec3(clip) / clip.w;
-
-                    sunUV = glm::vec2(ndc.x, ndc.y) * 0.5f + glm::vec2(0.5f);
-
-                    const float sunCosSize = 0.995f;
-                    float sunTheta = acos(sunCosSize);
-                    float tanTheta = tan(sunTheta);
-
-                    float P00 = P[0][0];
-                    float P11 = P[1][1];
-
-                    float rNdcX = tanTheta * P00;
-                    float rNdcY = tanTheta * P11;
-
-                    float rUvX = rNdcX * 0.5f;
-                    float rUvY = rNdcY * 0.5f;
-
-                    bool intersects = 
-                        sunUV.x >= -rUvX && sunUV.x <= 1.0f + rUvX &&
-                        sunUV.y >= -rUvY && sunUV.y <= 1.0f + rUvY;
-                    
-                    visibility = intersects ? 1.0f : 0.0f;
+                VkExtent2D outputExtent = extent;
+                VkDeviceSize captureSize = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+                if (imageConvertSystem) {
+                    if (stressCfg_.outputWidth > 0 && stressCfg_.outputHeight > 0) {
+                        outputExtent = { stressCfg_.outputWidth, stressCfg_.outputHeight };
+                    }
+                    outputExtent = imageConvertSystem->fitExtent(outputExtent);
+                    captureSize = imageConvertSystem->bufferSize(outputExtent);
                 }
 
-                ubo.sunScreen = glm::vec4(sunUV, visibility, 1.0f);
+                // state shared by every camera: sun, shadow map and lights
+                GlobalUbo sharedUbo{};
+                sharedUbo.ambientLightColor = glm::vec4(1.0f, 0.95f, 0.7f, 0.15f);
+                sharedUbo.sunDirection = glm::vec4(lightDir, 0.f);
+                sharedUbo.sunColor = sunColor;
 
-                ubo.ambientLightColor = glm::vec4(1.0f, 0.95f, 0.7f, 0.15f);
-                
-                ubo.sunDirection = glm::vec4(lightDir, 0.f);
-                ubo.sunColor = sunColor;
-                
                 glm::vec3 L = glm::normalize(lightDir); 
                 glm::vec3 center   = glm::vec3(0.0f);
                 glm::vec3 lightPos = center - L * 50.0f;
@@ -720,11 +1003,22 @@ namespace cvsim {
                     -orthoSize, orthoSize,
                     0.1f, 80.0f);
 
-                ubo.lightViewProj = lightProj * lightView;
+                sharedUbo.lightViewProj = lightProj * lightView;
+                const Frustum shadowFrustum = extractShadowCasterFrustum(sharedUbo.lightViewProj);
 
-                pointLightSystem.update(frameInfo, ubo);
-                uboBuffers[frameIndex]->writeToBuffer(&ubo);
-                uboBuffers[frameIndex]->flush();
+                if (lightBuffer.update(frameIndex, sceneStore, sceneStore.flushLights())) {
+                    auto lightInfo = lightBuffer.descriptorInfo(frameIndex);
+                    for (auto& view : views) {
+                        DescriptorWriter(*globalSetLayout, *globalPool)
+                            .writeBuffer(3, &lightInfo)
+                            .overwrite(view.globalSets[frameIndex]);
+                    }
+                }
+                sharedUbo.numLights = static_cast<int>(sceneStore.lightCount());
+
+                if (gpuCullSystem) {
+                    gpuCullSystem->update(frameIndex, sceneStore, changedSlots);
+                }
 
                 LensParamsGPU lensParams{};
                 lensParams.surfaceCount = static_cast<int>(lensSurfacesCpu.size());
@@ -733,12 +1027,96 @@ namespace cvsim {
                 lensParams.sensorW = 0.036f;
                 lensParams.sensorH = 0.024f;
 
-                lensParams.sensorW = 0.036f;
-                lensParams.sensorH = 0.024f;
-
                 lensParamsBuffers[frameIndex]->writeToBuffer(&lensParams);
                 lensParamsBuffers[frameIndex]->flush();
 
+                frameInfos.clear();
+                for (uint32_t v = 0; v < viewCount; ++v) {
+                    CpuTracer::Scope trace{ "view UBO", v };
+                    enginev::Camera& camera = cameras[v].camera;
+                    glm::mat4 VP = camera.getProjection() * camera.getView();
+                    Frustum frustum = [&] {
+                        CpuTracer::Scope frustumTrace{ "extract frustum", v };
+                        return extractFrustum(VP);
+                    }();
+
+                    FrameInfo frameInfo{ 
+                        frameIndex, 
+                        simDt, 
+                        commandBuffer, 
+                        camera,
+                        views[v].globalSets[frameIndex], 
+                        sceneStore,
+                        sceneBvh};
+                    frameInfo.frustum = frustum;
+                    frameInfo.shadowFrustum = shadowFrustum;
+                    frameInfo.viewIndex = v;
+                    frameInfos.push_back(frameInfo);
+
+                    GlobalUbo& ubo = viewUbos[v];
+                    ubo = sharedUbo;
+                    std::copy(std::begin(frustum.planes), std::end(frustum.planes), ubo.frustumPlanes);
+                    ubo.clusterParams = glm::vec4(
+                        CAMERA_NEAR, CAMERA_FAR,
+                        static_cast<float>(extent.width), static_cast<float>(extent.height));
+                    ubo.projection = camera.getProjection();
+                    ubo.view = camera.getView();
+                    ubo.inverseView = glm::inverse(camera.getView());
+
+                    glm::mat4 V = camera.getView();
+                    glm::mat4 P = camera.getProjection();
+                    glm::mat4 invV = ubo.inverseView;
+
+                    glm::vec3 camPos = glm::vec3(invV[3]);
+                    glm::vec3 camForward = glm::normalize(-glm::vec3(invV[2]));
+
+                    glm::vec3 sunWorld = camPos + (-lightDir) * 10000.0f;
+                    glm::vec3 sunWorldInv = camPos + (lightDir) * 10000.0f;
+                    glm::vec3 sunViewDir = glm::normalize(sunWorldInv - camPos);
+                    float dotFS = glm::clamp(glm::dot(camForward, sunViewDir), 0.0f, 1.0f);
+                    float sunFactor = glm::smoothstep(0.70f, 0.95f, dotFS);
+
+                    ubo.sunParams = glm::vec4(sunFactor, 0.f, 0.f, 0.f);
+
+
+                    glm::vec4 clip = P * V * glm::vec4(sunWorld, 1.0f);
+
+                    glm::vec2 sunUV(0.5f);
+                    float visibility = 0.0f;
+
+                    if (clip.w > 0.0f) {
+                        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+                        sunUV = glm::vec2(ndc.x, ndc.y) * 0.5f + glm::vec2(0.5f);
+
+                        const float sunCosSize = 0.995f;
+                        float sunTheta = acos(sunCosSize);
+                        float tanTheta = tan(sunTheta);
+
+                        float P00 = P[0][0];
+                        float P11 = P[1][1];
+
+                        float rNdcX = tanTheta * P00;
+                        float rNdcY = tanTheta * P11;
+
+                        float rUvX = rNdcX * 0.5f;
+                        float rUvY = rNdcY * 0.5f;
+
+                        bool intersects = 
+                            sunUV.x >= -rUvX && sunUV.x <= 1.0f + rUvX &&
+                            sunUV.y >= -rUvY && sunUV.y <= 1.0f + rUvY;
+                        
+                        visibility = intersects ? 1.0f : 0.0f;
+                    }
+
+                    ubo.sunScreen = glm::vec4(sunUV, visibility, 1.0f);
+
+                    views[v].uboBuffers[frameIndex]->writeToBuffer(&ubo);
+                    views[v].uboBuffers[frameIndex]->flush();
+                }
+
+                // the shadow map does not depend on the camera; every view's
+                // GlobalUbo carries the same lightViewProj
                 VkClearValue clearDepth{};
                 clearDepth.depthStencil = { 1.0f, 0 };
 
@@ -751,6 +1129,7 @@ namespace cvsim {
                 shadowRpInfo.clearValueCount     = 1;
                 shadowRpInfo.pClearValues        = &clearDepth;
 
+                gpuProfiler.beginScope(commandBuffer, shadowScope);
                 vkCmdBeginRenderPass(commandBuffer, &shadowRpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
                 VkViewport shadowViewport{};
@@ -767,85 +1146,223 @@ namespace cvsim {
                 shadowScissor.extent = shadowExtent;
                 vkCmdSetScissor(commandBuffer, 0, 1, &shadowScissor);
 
-                shadowRenderSystem.renderSimObjects(frameInfo);
+                shadowRenderSystem.renderSimObjects(frameInfos[0]);
 
                 vkCmdEndRenderPass(commandBuffer);
+                gpuProfiler.endScope(commandBuffer, shadowScope);
+
+                for (uint32_t v = 0; v < viewCount; ++v) {
+                    CpuTracer::Scope trace{ "record view", v };
+                    CameraView& view = views[v];
+                    FrameInfo& frameInfo = frameInfos[v];
+                    const ViewScopes& scopes = viewScopes[v];
+
+                    if (gpuCullSystem) {
+                        gpuProfiler.beginScope(commandBuffer, scopes.cull);
+                        gpuCullSystem->cull(frameInfo);
+                        gpuProfiler.endScope(commandBuffer, scopes.cull);
+                    }
+                    if (stressCfg_.clusteredLighting) {
+                        gpuProfiler.beginScope(commandBuffer, scopes.clusters);
+                        lightClusterSystem.dispatch(frameInfo, static_cast<uint32_t>(sharedUbo.numLights));
+                        gpuProfiler.endScope(commandBuffer, scopes.clusters);
+                    }
 
-                scenePass->begin(commandBuffer);
-
-                skyboxRenderSystem.render(frameInfo);
-                simpleRenderSystem.renderSimObjects(frameInfo);
-                pointLightSystem.render(frameInfo);
-
-                scenePass->end(commandBuffer);
-                
-                BrightPushConstant brightPC{};
-                brightPC.threshold = 0.85f;
-                brightPC.knee = 0.08f;
-
-                bloomPass->beginBright(commandBuffer);
-                brightExtractSystem.render(frameInfo, brightDescriptorSets[frameIndex], brightPC);
-                bloomPass->endBright(commandBuffer);
-                
-                BlurPushConstant blurPC{};
-                blurPC.texelSize = {
-                    1.0f / extent.width,
-                     1.0f / extent.height
-                };
-                blurPC.radius = 5.0f;
-
-                bloomPass->beginBlurH(commandBuffer);
-                blurHSystem.render(frameInfo, blurDescriptorSetsH[frameIndex], blurPC);
-                bloomPass->endBlurH(commandBuffer);
-
-                bloomPass->beginBlurV(commandBuffer);
-                blurVSystem.render(frameInfo, blurDescriptorSetsV[frameIndex], blurPC);
-                bloomPass->endBlurV(commandBuffer);
-
-                lensFlarePass->transitionToGeneral(commandBuffer);
-                lensFlarePass->dispatch(commandBuffer, lensDescriptorSets[frameIndex]);
-                lensFlarePass->transitionToShaderRead(commandBuffer);
-
-                exposureReduceSystem.dispatch(
-                    commandBuffer,
-                    extent,
-                    exposureReduceDescriptorSet[frameIndex]
-                );
-
-                VkMemoryBarrier barrier{};
-                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-                vkCmdPipelineBarrier(
-                    commandBuffer,
-                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                    0,
-                    1, &barrier,
-                    0, nullptr,
-                    0, nullptr
-                );
+                    gpuProfiler.beginScope(commandBuffer, scopes.scene);
+                    view.scenePass->begin(commandBuffer);
+
+                    skyboxRenderSystem.render(frameInfo);
+                    simpleRenderSystem.renderSimObjects(frameInfo);
+                    pointLightSystem.render(frameInfo);
+                    benchStats.drawCalls += simpleRenderSystem.getLastDrawCount();
+                    benchStats.visible += simpleRenderSystem.getLastVisibleCount();
+                    benchStats.tested += simpleRenderSystem.getLastTestedCount();
+
+                    view.scenePass->end(commandBuffer);
+                    gpuProfiler.endScope(commandBuffer, scopes.scene);
+
+                    if (labelOutput) {
+                        const VkExtent2D labelExtent = view.scenePass->getExtent();
+                        ReadbackRing::Slot* labelCapture = view.labelRing->acquire(
+                            VkDeviceSize(labelExtent.width) * labelExtent.height * sizeof(uint32_t),
+                            labelExtent.width, labelExtent.height);
+                        labelCaptures[v] = labelCapture;
+
+                        if (labelCapture) {
+                            gpuProfiler.beginScope(commandBuffer, scopes.labels);
+                            view.scenePass->copyLabelToBuffer(commandBuffer, labelCapture->buffer);
+                            gpuProfiler.endScope(commandBuffer, scopes.labels);
+                        }
+                    }
 
-                exposureUpdateSystem.dispatch(
-                    commandBuffer,
-                    exposureUpdateDescriptorSet[frameIndex]
-                );
+                    if (depthExportSystem) {
+                        ReadbackRing::Slot* depthCapture = view.depthRing->acquire(
+                            depthExportSystem->bufferSize(outputExtent), outputExtent.width, outputExtent.height);
+                        depthCaptures[v] = depthCapture;
+
+                        if (depthCapture) {
+                            gpuProfiler.beginScope(commandBuffer, scopes.depth);
+                            depthExportSystem->record(
+                                commandBuffer, frameIndex, v,
+                                view.scenePass->getDepthView(),
+                                view.scenePass->getDepthSampler(),
+                                CAMERA_NEAR, CAMERA_FAR,
+                                outputExtent,
+                                depthCapture->buffer);
+                            gpuProfiler.endScope(commandBuffer, scopes.depth);
+                        }
+                    }
+                    
+                    BrightPushConstant brightPC{};
+                    brightPC.threshold = 0.85f;
+                    brightPC.knee = 0.08f;
+
+                    gpuProfiler.beginScope(commandBuffer, scopes.bloom);
+                    view.bloomPass->beginBright(commandBuffer);
+                    brightExtractSystem.render(frameInfo, view.brightSets[frameIndex], brightPC);
+                    view.bloomPass->endBright(commandBuffer);
+                    
+                    BlurPushConstant blurPC{};
+                    blurPC.texelSize = {
+                        1.0f / extent.width,
+                         1.0f / extent.height
+                    };
+                    blurPC.radius = 5.0f;
+
+                    view.bloomPass->beginBlurH(commandBuffer);
+                    blurHSystem.render(frameInfo, view.blurSetsH[frameIndex], blurPC);
+                    view.bloomPass->endBlurH(commandBuffer);
+
+                    view.bloomPass->beginBlurV(commandBuffer);
+                    blurVSystem.render(frameInfo, view.blurSetsV[frameIndex], blurPC);
+                    view.bloomPass->endBlurV(commandBuffer);
+                    gpuProfiler.endScope(commandBuffer, scopes.bloom);
+
+                    gpuProfiler.beginScope(commandBuffer, scopes.lensFlare);
+                    view.lensFlarePass->transitionToGeneral(commandBuffer);
+                    view.lensFlarePass->dispatch(commandBuffer, view.lensSets[frameIndex]);
+                    view.lensFlarePass->transitionToShaderRead(commandBuffer);
+                    gpuProfiler.endScope(commandBuffer, scopes.lensFlare);
+
+                    gpuProfiler.beginScope(commandBuffer, scopes.exposure);
+                    exposureReduceSystem.dispatch(
+                        commandBuffer,
+                        extent,
+                        view.exposureReduceSets[frameIndex]
+                    );
+
+                    VkMemoryBarrier barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+                    vkCmdPipelineBarrier(
+                        commandBuffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        0,
+                        1, &barrier,
+                        0, nullptr,
+                        0, nullptr
+                    );
+
+                    exposureUpdateSystem.dispatch(
+                        commandBuffer,
+                        view.exposureUpdateSets[frameIndex]
+                    );
+                    gpuProfiler.endScope(commandBuffer, scopes.exposure);
+
+                    {
+                        CpuTracer::Scope exposureTrace{ "exposure UBO", v };
+                        ExposureState cpuExp{};
+                        std::memcpy(&cpuExp, view.exposureState->getMappedMemory(), sizeof(ExposureState));
+
+                        GlobalUbo& ubo = viewUbos[v];
+                        ubo.autoExposure = cpuExp.autoExposure;
+                        view.uboBuffers[frameIndex]->writeToBuffer(
+                            &ubo.autoExposure, sizeof(ubo.autoExposure), offsetof(GlobalUbo, autoExposure));
+                        view.uboBuffers[frameIndex]->flush();
+                    }
 
-                ExposureState cpuExp{};
-                std::memcpy(&cpuExp, exposureState->getMappedMemory(), sizeof(ExposureState));
+                    ReadbackRing::Slot* capture = view.captureRing->acquire(
+                        captureSize, outputExtent.width, outputExtent.height);
+                    captures[v] = capture;
+
+                    // swap chain images cannot be sampled, so a converted
+                    // frame is always rendered into the view's own target;
+                    // headless then has nothing left to draw into the
+                    // renderer's image
+                    const bool shown = static_cast<int>(v) == activeCam && (window || !imageConvertSystem);
+
+                    if (shown) {
+                        gpuProfiler.beginScope(commandBuffer, scopes.post);
+                        renderer.beginSwapChainRenderPass(commandBuffer);
+                        postProcessSystem.render(frameInfo, view.postSets[frameIndex]);
+                        renderer.endSwapChainRenderPass(commandBuffer);
+                        gpuProfiler.endScope(commandBuffer, scopes.post);
+
+                        gpuProfiler.beginScope(commandBuffer, scopes.copy);
+                        if (capture && !imageConvertSystem) {
+                            renderer.copySwapImageToBuffer(commandBuffer, capture->buffer);
+                        } else {
+                            renderer.transitionSwapImageToPresent(commandBuffer);
+                        }
+                        gpuProfiler.endScope(commandBuffer, scopes.copy);
+                    }
 
-                ubo.autoExposure = cpuExp.autoExposure;     
-                uboBuffers[frameIndex]->writeToBuffer(&ubo);
-                uboBuffers[frameIndex]->flush();
+                    // with the ring full there is nothing to publish
+                    if (capture && (!shown || imageConvertSystem)) {
+                        const uint32_t targetIndex = static_cast<uint32_t>(frameIndex);
+                        gpuProfiler.beginScope(commandBuffer, scopes.post);
+                        view.target->beginRenderPass(commandBuffer, targetIndex);
+                        viewPostProcessSystem->render(frameInfo, view.postSets[frameIndex]);
+                        vkCmdEndRenderPass(commandBuffer);
+                        gpuProfiler.endScope(commandBuffer, scopes.post);
+
+                        gpuProfiler.beginScope(commandBuffer, scopes.copy);
+                        if (imageConvertSystem) {
+                            imageConvertSystem->convert(
+                                commandBuffer, frameIndex, v,
+                                view.target->getImage(targetIndex),
+                                view.target->getImageView(targetIndex),
+                                outputExtent,
+                                capture->buffer);
+                        } else {
+                            view.target->copyImageToBuffer(commandBuffer, targetIndex, capture->buffer);
+                        }
+                        gpuProfiler.endScope(commandBuffer, scopes.copy);
+                    }
+                }
 
-                renderer.beginSwapChainRenderPass(commandBuffer);
-                postProcessSystem.render(frameInfo, postDescriptorSets[frameIndex]);
-                renderer.endSwapChainRenderPass(commandBuffer);
+                gpuProfiler.endFrame(commandBuffer);
+                renderer.endFrame();
+                for (uint32_t v = 0; v < viewCount; ++v) {
+                    CpuTracer::Scope trace{ "submit readbacks", v };
+                    if (captures[v]) {
+                        views[v].captureRing->submit(captures[v]);
+                    }
+                    if (depthCaptures[v]) {
+                        views[v].depthRing->submit(depthCaptures[v]);
+                    }
+                    if (labelCaptures[v]) {
+                        views[v].labelRing->submit(labelCaptures[v]);
+                    }
+                }
 
+                if (benchmark) {
+                    benchStats.cpuMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - newTime).count();
+                    benchmark->endFrame(renderer.getFrameNumber(), benchStats);
+                }
 
-                renderer.copySwapImageToBuffer(commandBuffer, captures[frameIndex].buf);
-                renderer.endFrame();
+                if (!freshCmdTimes.empty()) {
+                    const int64_t submitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                    for (int64_t receiveNs : freshCmdTimes) {
+                        cmdLatencySum += static_cast<double>(submitNs - receiveNs) * 1e-6;
+                        ++cmdLatencyCount;
+                    }
+                }
 
                 fpsWindowTime += frameTime;
                 fpsWindowFrames += 1;
@@ -856,34 +1373,63 @@ namespace cvsim {
                 if (fpsWindowTime >= fpsPrintPeriod) {
                     const double fps = static_cast<double>(fpsWindowFrames) / fpsWindowTime;
                     std::cout << "FPS: " << fps << std::endl;
+                    if (cmdLatencyCount > 0) {
+                        std::cout << "camera_cmd -> frame submit: "
+                            << cmdLatencySum / static_cast<double>(cmdLatencyCount) << " ms avg over "
+                            << cmdLatencyCount << " commands" << std::endl;
+                    }
+                    if (gpuProfiler.isEnabled()) {
+                        const std::vector<GpuProfiler::ScopeTiming> timings = gpuProfiler.getTimings();
+                        std::vector<std::pair<std::string, std::string>> diagnostics;
+                        std::string line = "GPU ms (avg):";
+                        char value[32];
+                        for (const auto& timing : timings) {
+                            std::snprintf(value, sizeof(value), "%.3f", timing.averageMs);
+                            line += " " + timing.name + " " + value;
+                            diagnostics.emplace_back(timing.name + " avg ms", value);
+                        }
+                        std::cout << line << std::endl;
+                        if (stressCfg_.gpuDiagnostics) {
+                            ros.publishDiagnostics("cv_simulator: GPU stage times", device.properties.deviceName, diagnostics);
+                        }
+                    }
 
                     fpsWindowTime = 0.0;
                     fpsWindowFrames = 0;
+                    cmdLatencySum = 0.0;
+                    cmdLatencyCount = 0;
                 }
-                
-                ros.publishBGRA8(
-                  extent.width, extent.height,
-                  captures[frameIndex].mapped,
-                  captures[frameIndex].size);
+
+                if (benchmark && benchmark->isFinished()) {
+                    uint64_t droppedCaptures = 0;
+                    for (const auto& view : views) {
+                        droppedCaptures += view.captureRing->getDroppedFrames();
+                    }
+                    benchmark->writeReport(device.properties.deviceName, droppedCaptures);
+                    break;
+                }
+
             }
         }
 
-        for (auto& c : captures) {
-            if (c.mapped) vkUnmapMemory(device.device(), c.mem);
-            if (c.buf) vkDestroyBuffer(device.device(), c.buf, nullptr);
-            if (c.mem) vkFreeMemory(device.device(), c.mem, nullptr);
-            
+        if (tracing) {
+            writeTrace();
         }
+
         vkDeviceWaitIdle(device.device());
-        if (lensFlarePass) 
-        {
-            lensFlarePass->destroy();
-            lensFlarePass.reset();
+        // everything is still alive here: scene, render targets, rings
+        printMemoryStats("exit", device.getAllocator().getStats());
+        for (auto& view : views) {
+            // stop the publishing workers before the buffers go away
+            view.captureRing.reset();
+            view.depthRing.reset();
+            view.labelRing.reset();
+
+            view.lensFlarePass->destroy();
+            view.bloomPass->destroy();
+            view.scenePass->destroy();
         }
 
-        bloomPass->destroy();
-        scenePass->destroy();
-
         destroyShadowResources();
         destroySkyboxCubemap();
 
@@ -964,21 +1510,6 @@ namespace cvsim {
 
         VkDeviceSize imageSize = faceSize * faces.size();
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-
-        device.createBuffer(
-            imageSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer,
-            stagingBufferMemory);
-
-        void* data = nullptr;
-        vkMapMemory(device.device(), stagingBufferMemory, 0, imageSize, 0, &data);
-        std::memcpy(data, pixelData.data(), static_cast<size_t>(imageSize));
-        vkUnmapMemory(device.device(), stagingBufferMemory);
-
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
@@ -1000,32 +1531,18 @@ namespace cvsim {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             skyboxImage,
-            skyboxImageMemory);
+            skyboxImageAllocation);
 
-        device.transitionImageLayout(
-            skyboxImage,
-            imageInfo.format,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            6);
-
-        device.copyBufferToImage(
-            stagingBuffer,
+        // flushed together with the scene models; nothing samples the
+        // cubemap before run()
+        uploader_.uploadImage(
             skyboxImage,
+            pixelData.data(),
+            imageSize,
             static_cast<uint32_t>(texWidth),
             static_cast<uint32_t>(texHeight),
             6);
 
-        device.transitionImageLayout(
-            skyboxImage,
-            imageInfo.format,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            6);
-
-        vkDestroyBuffer(device.device(), stagingBuffer, nullptr);
-        vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
-
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image    = skyboxImage;
@@ -1154,7 +1671,7 @@ namespace cvsim {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             shadowImage,
-            shadowImageMemory);
+            shadowImageAllocation);
 
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1229,7 +1746,7 @@ namespace cvsim {
                 
 
 
-                simObjects.emplace(pointLight.getId(), std::move(pointLight));
+                sceneStore.add(std::move(pointLight));
             }
         }
         if (scene.contains("sun")) {
@@ -1266,9 +1783,17 @@ namespace cvsim {
                 );
             }
 
+            loadModels_({ modelPath });
             std::shared_ptr<Model> sharedModel = getModelCached_(modelPath);
 
-            simObjects.reserve(simObjects.size() + static_cast<size_t>(stressCount) + 16);
+            uint32_t semanticClass = 0;
+            if (scene.contains("objects") && !scene["objects"].empty()) {
+                semanticClass = scene["objects"][0].value("class", 0u);
+            }
+
+            sceneStore.reserve(
+                sceneStore.objectCount() + static_cast<size_t>(stressCount) + 16,
+                sceneStore.lightCount() + static_cast<size_t>(stressCount) + 16);
 
             const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(stressCount))));
             const float half = 0.5f * static_cast<float>(side - 1);
@@ -1283,6 +1808,7 @@ namespace cvsim {
                     for (int z = 0; z < side && created < stressCount; ++z) {
                         auto simObj = SimObject::createSimObject();
                         simObj.model = sharedModel;
+                        simObj.semanticClass = semanticClass;
 
                         glm::vec3 objPos{
                             (static_cast<float>(x) - half) * spacing,
@@ -1293,7 +1819,7 @@ namespace cvsim {
                         simObj.transform.rotation = { 0.0f, 0.0f, 0.0f };
                         simObj.transform.scale = { 1.0f, 1.0f, 1.0f };
 
-                        simObjects.emplace(simObj.getId(), std::move(simObj));
+                        sceneStore.add(std::move(simObj));
                         ++created;
 
                         auto light = SimObject::makePointLight(stressLightIntensity);
@@ -1305,7 +1831,7 @@ namespace cvsim {
 
                         light.transform.translation = objPos + glm::vec3(sx, sy, sz);
 
-                        simObjects.emplace(light.getId(), std::move(light));
+                        sceneStore.add(std::move(light));
 
                         ++created;
 
@@ -1321,13 +1847,24 @@ namespace cvsim {
         }
 
         if (scene.contains("objects")) {
+            if (!stressCfg_.streamModels) {
+                // every model once, however many objects share it
+                std::vector<std::string> modelPaths;
+                for (auto& obj : scene["objects"]) {
+                    modelPaths.push_back(obj["model"].get<std::string>());
+                }
+                loadModels_(modelPaths);
+            }
+
+            sceneStore.reserve(
+                sceneStore.objectCount() + scene["objects"].size(),
+                sceneStore.lightCount());
+
             for (auto& obj : scene["objects"]) {
                 std::string modelPath = obj["model"];
 
-                std::shared_ptr<Model> model = Model::createModelFromFile(device, modelPath);
-
                 auto simObj = SimObject::createSimObject();
-                simObj.model = model;
+                simObj.semanticClass = obj.value("class", 0u);
 
                 simObj.transform.translation = {
                     obj["position"][0],
@@ -1346,7 +1883,13 @@ namespace cvsim {
                     obj["scale"][1],
                     obj["scale"][2] 
                 };
-                simObjects.emplace(simObj.getId(), std::move(simObj));
+
+                if (stressCfg_.streamModels) {
+                    streamObject_(modelPath, std::move(simObj));
+                    continue;
+                }
+                simObj.model = getModelCached_(modelPath);
+                sceneStore.add(std::move(simObj));
             }
         }
     }
@@ -0,0 +1,245 @@
+#include "benchmark.hpp"
+
+#include "app.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace cvsim {
+
+    namespace {
+
+        glm::vec3 readVec3(const nlohmann::json& value, const char* what) {
+            if (!value.is_array() || value.size() != 3) {
+                throw std::runtime_error(std::string("benchmark spec: ") + what + " must be [x, y, z]");
+            }
+            return { value[0].get<float>(), value[1].get<float>(), value[2].get<float>() };
+        }
+
+        glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t) {
+            const float t2 = t * t;
+            const float t3 = t2 * t;
+            return 0.5f * (
+                2.f * p1 +
+                (p2 - p0) * t +
+                (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 +
+                (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+        }
+
+        // nearest-rank percentile of sorted values
+        double percentile(const std::vector<double>& sorted, double p) {
+            const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+            return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+        }
+
+        nlohmann::json summarize(std::vector<double> values) {
+            if (values.empty()) {
+                return nullptr;
+            }
+            std::sort(values.begin(), values.end());
+
+            double sum = 0.0;
+            for (double v : values) sum += v;
+
+            return {
+                { "samples", values.size() },
+                { "mean", sum / static_cast<double>(values.size()) },
+                { "min", values.front() },
+                { "p50", percentile(values, 50.0) },
+                { "p95", percentile(values, 95.0) },
+                { "p99", percentile(values, 99.0) },
+                { "max", values.back() },
+            };
+        }
+    }
+
+    BenchmarkSpec BenchmarkSpec::load(const std::string& specPath, StressConfig& cfg) {
+        std::ifstream file(specPath);
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open benchmark spec: " + specPath);
+        }
+
+        nlohmann::json json;
+        file >> json;
+
+        BenchmarkSpec spec;
+        spec.path = specPath;
+        spec.warmupFrames = json.value("warmupFrames", spec.warmupFrames);
+        spec.frames = json.value("frames", spec.frames);
+        spec.dt = json.value("dt", spec.dt);
+        spec.outputPath = json.value("output", spec.outputPath);
+        if (spec.frames == 0 || spec.dt <= 0.f) {
+            throw std::runtime_error("benchmark spec: frames and dt must be positive");
+        }
+
+        if (json.contains("scene")) {
+            cfg.scenePath = json["scene"].get<std::string>();
+        }
+        if (json.contains("stress")) {
+            const auto& stress = json["stress"];
+            cfg.enabled = true;
+            cfg.count = stress.value("count", cfg.count);
+            cfg.spacing = stress.value("spacing", cfg.spacing);
+            cfg.modelPath = stress.value("model", cfg.modelPath);
+        }
+        cfg.gpuCulling = json.value("gpuCulling", cfg.gpuCulling);
+        cfg.instancing = json.value("instancing", cfg.instancing);
+        cfg.clusteredLighting = json.value("clusteredLighting", cfg.clusteredLighting);
+
+        if (json.contains("camera")) {
+            const auto& camera = json["camera"];
+            spec.loopPath = camera.value("loop", false);
+            for (const auto& point : camera.at("path")) {
+                PathPoint p;
+                p.position = readVec3(point.at("position"), "camera path position");
+                if (point.contains("rotation")) {
+                    p.rotation = readVec3(point["rotation"], "camera path rotation");
+                }
+                spec.cameraPath.push_back(p);
+            }
+        }
+        if (spec.cameraPath.empty()) {
+            // a slow orbit-like sweep in front of the default camera
+            spec.cameraPath = {
+                { { 0.f, 0.f, -2.5f }, { 0.f, 0.f, 0.f } },
+                { { 2.f, 1.f, -4.f }, { 0.2f, -0.5f, 0.f } },
+                { { 0.f, 2.f, -6.f }, { 0.3f, 0.f, 0.f } },
+                { { -2.f, 1.f, -4.f }, { 0.2f, 0.5f, 0.f } },
+            };
+            spec.loopPath = true;
+        }
+
+        return spec;
+    }
+
+    BenchmarkRun::BenchmarkRun(BenchmarkSpec spec, uint32_t drainFrames)
+        : spec{ std::move(spec) }, drainFrames{ drainFrames } {
+        cpuMs.reserve(this->spec.frames);
+        gpuMs.reserve(this->spec.frames);
+        drawCalls.reserve(this->spec.frames);
+        visible.reserve(this->spec.frames);
+        culled.reserve(this->spec.frames);
+        measuring.store(isMeasuring(), std::memory_order_relaxed);
+    }
+
+    void BenchmarkRun::cameraPose(glm::vec3& position, glm::vec3& rotation) const {
+        const auto& path = spec.cameraPath;
+        const size_t count = path.size();
+        if (count == 1) {
+            position = path[0].position;
+            rotation = path[0].rotation;
+            return;
+        }
+
+        // 0 during warm-up, 1 while draining
+        const float u = frame <= spec.warmupFrames ? 0.f
+            : std::min(1.f, static_cast<float>(frame - spec.warmupFrames) / static_cast<float>(spec.frames));
+
+        const size_t segments = spec.loopPath ? count : count - 1;
+        const float s = u * static_cast<float>(segments);
+        const size_t segment = std::min(static_cast<size_t>(s), segments - 1);
+        const float t = s - static_cast<float>(segment);
+
+        auto point = [&](ptrdiff_t i) -> const PathPoint& {
+            if (spec.loopPath) {
+                const ptrdiff_t n = static_cast<ptrdiff_t>(count);
+                return path[static_cast<size_t>(((i % n) + n) % n)];
+            }
+            return path[static_cast<size_t>(std::clamp<ptrdiff_t>(i, 0, static_cast<ptrdiff_t>(count) - 1))];
+        };
+
+        const ptrdiff_t i = static_cast<ptrdiff_t>(segment);
+        position = catmullRom(point(i - 1).position, point(i).position, point(i + 1).position, point(i + 2).position, t);
+        rotation = catmullRom(point(i - 1).rotation, point(i).rotation, point(i + 1).rotation, point(i + 2).rotation, t);
+    }
+
+    void BenchmarkRun::endFrame(uint64_t rendererFrame, const FrameStats& stats) {
+        if (isMeasuring()) {
+            if (frame == spec.warmupFrames) {
+                firstMeasuredFrame = rendererFrame;
+            }
+            lastMeasuredFrame = rendererFrame;
+
+            cpuMs.push_back(stats.cpuMs);
+            drawCalls.push_back(static_cast<double>(stats.drawCalls));
+            visible.push_back(static_cast<double>(stats.visible));
+            culled.push_back(static_cast<double>(stats.tested - std::min(stats.tested, stats.visible)));
+        }
+
+        ++frame;
+        measuring.store(isMeasuring(), std::memory_order_relaxed);
+    }
+
+    void BenchmarkRun::addGpuFrameTime(uint64_t rendererFrame, double milliseconds) {
+        if (firstMeasuredFrame != 0 &&
+            rendererFrame >= firstMeasuredFrame && rendererFrame <= lastMeasuredFrame) {
+            gpuMs.push_back(milliseconds);
+        }
+    }
+
+    void BenchmarkRun::addGpuScopeTime(uint64_t rendererFrame, const std::string& scope, double milliseconds) {
+        if (firstMeasuredFrame != 0 &&
+            rendererFrame >= firstMeasuredFrame && rendererFrame <= lastMeasuredFrame) {
+            gpuScopeMs[scope].push_back(milliseconds);
+        }
+    }
+
+    void BenchmarkRun::addReadbackLatency(double milliseconds) {
+        if (!measuring.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        readbackMs.push_back(milliseconds);
+    }
+
+    void BenchmarkRun::writeReport(const std::string& deviceName, uint64_t droppedCaptures) const {
+        nlohmann::json report;
+        report["spec"] = spec.path;
+        report["device"] = deviceName;
+        report["warmupFrames"] = spec.warmupFrames;
+        report["frames"] = spec.frames;
+        report["cpuFrameMs"] = summarize(cpuMs);
+        report["gpuFrameMs"] = summarize(gpuMs);
+        report["gpuScopeMs"] = nlohmann::json::object();
+        for (const auto& [scope, values] : gpuScopeMs) {
+            report["gpuScopeMs"][scope] = summarize(values);
+        }
+        report["drawCalls"] = summarize(drawCalls);
+        report["visibleObjects"] = summarize(visible);
+        report["culledObjects"] = summarize(culled);
+        {
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            report["readbackLatencyMs"] = summarize(readbackMs);
+        }
+        report["droppedCaptures"] = droppedCaptures;
+
+        std::ofstream out(spec.outputPath);
+        if (!out.is_open()) {
+            throw std::runtime_error("failed to write benchmark report: " + spec.outputPath);
+        }
+        out << report.dump(2) << '\n';
+
+        auto print = [&](const char* name, const nlohmann::json& s) {
+            if (s.is_null()) {
+                std::printf("%-22s n/a\n", name);
+                return;
+            }
+            std::printf("%-22s p50 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f\n", name,
+                s["p50"].get<double>(), s["p95"].get<double>(), s["p99"].get<double>(), s["max"].get<double>());
+        };
+        std::printf("Benchmark %s: %u frames on %s\n", spec.path.c_str(), spec.frames, deviceName.c_str());
+        print("CPU frame ms", report["cpuFrameMs"]);
+        print("GPU frame ms", report["gpuFrameMs"]);
+        for (const auto& [scope, summary] : report["gpuScopeMs"].items()) {
+            print(("  " + scope).c_str(), summary);
+        }
+        print("readback latency ms", report["readbackLatencyMs"]);
+        std::printf("report written to %s\n", spec.outputPath.c_str());
+    }
+}
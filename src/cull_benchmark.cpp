@@ -0,0 +1,117 @@
+#include "cull_benchmark.hpp"
+
+#include "camera.hpp"
+#include "frustum.hpp"
+#include "frustum_cull.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace cvsim {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        struct BenchResult {
+            double nsPerObject = 0.0;
+            size_t visible = 0;
+        };
+
+        // Runs fn repeatedly for at least minSeconds and returns the best
+        // per-object time of a single run.
+        template <typename Fn>
+        BenchResult timeKernel(size_t count, double minSeconds, Fn&& fn) {
+            BenchResult result{};
+            double best = 1e30;
+            double total = 0.0;
+            int runs = 0;
+            while (total < minSeconds || runs < 3) {
+                auto start = Clock::now();
+                result.visible = fn();
+                double sec = std::chrono::duration<double>(Clock::now() - start).count();
+                best = std::min(best, sec);
+                total += sec;
+                ++runs;
+            }
+            result.nsPerObject = best * 1e9 / static_cast<double>(count);
+            return result;
+        }
+    }
+
+    int RunCullingBenchmark() {
+        const size_t counts[] = { 10000, 100000, 1000000 };
+
+        enginev::Camera camera{};
+        camera.setPerspectiveProjection(glm::radians(50.f), 800.f / 600.f, 0.1f, 100.f);
+        camera.setViewYXZ(glm::vec3(0.f, 0.f, -20.f), glm::vec3(0.1f, 0.3f, 0.f));
+        const Frustum frustum = extractFrustum(camera.getProjection() * camera.getView());
+
+        std::printf("Frustum culling benchmark, SIMD kernel: %s\n", enginev::cullKernelName());
+        std::printf("%10s %10s %14s %14s %14s %9s\n",
+            "objects", "visible", "isVisible ns", "scalar SoA ns", "SIMD ns", "speedup");
+
+        bool mismatch = false;
+        for (size_t count : counts) {
+            std::mt19937 rng(1234u);
+            const float half = std::cbrt(static_cast<float>(count));
+            std::uniform_real_distribution<float> pos(-half, half);
+            std::uniform_real_distribution<float> rad(0.25f, 1.0f);
+
+            std::vector<glm::vec4> spheres(count);
+            std::vector<float> xs(count), ys(count), zs(count), rs(count);
+            for (size_t i = 0; i < count; ++i) {
+                spheres[i] = glm::vec4(pos(rng), pos(rng), pos(rng), rad(rng));
+                xs[i] = spheres[i].x;
+                ys[i] = spheres[i].y;
+                zs[i] = spheres[i].z;
+                rs[i] = spheres[i].w;
+            }
+            std::vector<uint32_t> visible(count);
+
+            BenchResult baseline = timeKernel(count, 0.25, [&]() {
+                size_t n = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (isVisible(frustum, glm::vec3(spheres[i]), spheres[i].w)) {
+                        visible[n++] = static_cast<uint32_t>(i);
+                    }
+                }
+                return n;
+            });
+
+            BenchResult scalar = timeKernel(count, 0.25, [&]() {
+                return enginev::cullSpheresScalar(
+                    frustum, xs.data(), ys.data(), zs.data(), rs.data(), count, visible.data());
+            });
+
+            BenchResult simd = timeKernel(count, 0.25, [&]() {
+                return enginev::cullSpheres(
+                    frustum, xs.data(), ys.data(), zs.data(), rs.data(), count, visible.data());
+            });
+
+            if (baseline.visible != scalar.visible || baseline.visible != simd.visible) {
+                mismatch = true;
+            }
+
+            std::printf("%10zu %10zu %14.3f %14.3f %14.3f %8.2fx\n",
+                count, simd.visible,
+                baseline.nsPerObject, scalar.nsPerObject, simd.nsPerObject,
+                baseline.nsPerObject / simd.nsPerObject);
+        }
+
+        if (mismatch) {
+            std::fprintf(stderr, "Culling kernels disagree on the visible count\n");
+            return 1;
+        }
+        return 0;
+    }
+}
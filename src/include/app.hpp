@@ -2,6 +2,8 @@
 
 #include "window.hpp"
 #include "object.hpp"
+#include "scene_store.hpp"
+#include "scene_bvh.hpp"
 #include "renderer.hpp"
 #include "device.hpp"
 #include "descriptors.hpp"
@@ -9,10 +11,18 @@
 #include "scene_pass.hpp"
 #include "bloom_pass.hpp"
 #include "lens_flare_pass.hpp"
+#include "offscreen_target.hpp"
+#include "buffer.hpp"
+#include "readback_ring.hpp"
+#include "benchmark.hpp"
+#include "upload_batcher.hpp"
+#include "mesh_cache.hpp"
+#include "thread_pool.hpp"
 
 #include <unordered_map>
 #include <string>
 #include <array> 
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -27,6 +37,47 @@ namespace cvsim {
 		std::string modelPath; // optional
 
 		std::string scenePath = "../assets/scene_config.json";
+
+		bool instancing = true;
+		bool gpuCulling = false;
+		bool clusteredLighting = true;
+
+		// no window or swap chain: render into an offscreen target and
+		// only publish, as fast as the GPU allows
+		bool headless = false;
+
+		// encoding of the published images (bgra8, rgb8, mono8, yuv422)
+		// and their size, 0 x 0 for the render resolution; anything but
+		// full-size bgra8 is converted on the GPU before readback
+		std::string imageEncoding = "bgra8";
+		uint32_t outputWidth = 0;
+		uint32_t outputHeight = 0;
+
+		// depth output next to every image topic (32FC1 metres or 16UC1
+		// millimetres), empty for none
+		std::string depthEncoding;
+
+		// per-pixel label output next to every image topic: "instance"
+		// (object id + 1) or "semantic" (the objects' "class" from the
+		// scene config), empty for none
+		std::string labelMode;
+
+		// --benchmark spec file (see BenchmarkSpec), empty for a normal run
+		std::string benchmarkPath;
+
+		// per-stage GPU timestamps, averaged on the console every second;
+		// gpuDiagnostics also publishes them on /diagnostics. A benchmark
+		// always profiles and reports them.
+		bool gpuProfile = false;
+		bool gpuDiagnostics = false;
+
+		// Chrome trace_event JSON of the CPU frame phases (CpuTracer),
+		// written on exit and when T is pressed; empty for no tracing
+		std::string tracePath;
+
+		// start rendering right away and add the scene objects as their
+		// models finish loading, uploaded on the transfer queue
+		bool streamModels = false;
 	};
 
 	enum class CameraControlType { Keyboard, ROS };
@@ -37,6 +88,10 @@ namespace cvsim {
 		enginev::Camera camera{};
 		enginev::SimObject rig;
 		CameraControlType control = CameraControlType::Keyboard;
+		// RosImageBridge command subscription of a ROS camera (0 is the
+		// shared /sim/camera_cmd) and the last command applied from it
+		size_t cmdSubscription = 0;
+		uint64_t lastCmdSequence = 0;
 
 		float yawSpeed = 1.0f;
 		float pitchSpeed = 1.0f;
@@ -84,11 +139,36 @@ namespace cvsim {
 		}
 	};
 
-	struct FrameCapture {
-		VkBuffer buf{ VK_NULL_HANDLE };
-		VkDeviceMemory mem{ VK_NULL_HANDLE };
-		void* mapped{ nullptr };
-		size_t size{ 0 };
+	// Everything one camera renders into: its own passes, uniforms and
+	// exposure state, plus the target and topic it is published through.
+	// Shadow map, lights and object data are shared between all views.
+	struct CameraView {
+		std::unique_ptr<ScenePass> scenePass;
+		std::unique_ptr<BloomPass> bloomPass;
+		std::unique_ptr<LensFlarePass> lensFlarePass;
+		std::unique_ptr<OffscreenTarget> target;  // null if it only ever draws into the swap chain
+
+		std::vector<std::unique_ptr<Buffer>> uboBuffers;
+		std::unique_ptr<Buffer> exposureData;
+		std::unique_ptr<Buffer> exposureState;
+
+		std::vector<VkDescriptorSet> globalSets;
+		std::vector<VkDescriptorSet> brightSets;
+		std::vector<VkDescriptorSet> blurSetsH;
+		std::vector<VkDescriptorSet> blurSetsV;
+		std::vector<VkDescriptorSet> postSets;
+		std::vector<VkDescriptorSet> lensSets;
+		std::vector<VkDescriptorSet> exposureReduceSets;
+		std::vector<VkDescriptorSet> exposureUpdateSets;
+
+		size_t publisher = 0;
+		std::unique_ptr<ReadbackRing> captureRing;
+
+		size_t depthPublisher = 0;
+		std::unique_ptr<ReadbackRing> depthRing;  // null without depth output
+
+		size_t labelPublisher = 0;
+		std::unique_ptr<ReadbackRing> labelRing;  // null without label output
 	};
 
 	class SimApp {
@@ -99,6 +179,9 @@ namespace cvsim {
 		static constexpr int WIDTH = 800;
 		static constexpr int HEIGHT = 600;
 
+		// descriptor pool is sized for this many cameras
+		static constexpr uint32_t MAX_CAMERA_VIEWS = 4;
+
 		SimApp();
 		explicit SimApp(const StressConfig& stressCfg);
 		~SimApp();
@@ -111,30 +194,47 @@ namespace cvsim {
 	private:
 
 		StressConfig stressCfg_{};
+		std::unique_ptr<BenchmarkRun> benchmark_;  // null outside --benchmark
 
 		void loadSimObjects();
 
-		Window window{ WIDTH, HEIGHT, "CV Sim!" };
-		Device device{ window };
-		Renderer renderer{ window, device };
+		std::unique_ptr<Window> window;  // null in headless mode
+		Device device;
+		Renderer renderer;
+		// startup uploads (models, skybox) share its batches
+		UploadBatcher uploader_{ device };
 
-		std::unique_ptr<ScenePass> scenePass;
-		std::unique_ptr<BloomPass> bloomPass;
-		std::vector<VkDescriptorSet> postDescriptorSets;
 		std::unique_ptr<DescriptorSetLayout> postSetLayout;
-		std::unique_ptr<LensFlarePass> lensFlarePass;
 		std::vector<LensSurfaceGPU> lenSurfacesCpu;
 		glm::vec3 lightDir{0.0f};
 		glm::vec4 sunColor{1.f, 0.95f, 0.7f, 1.f};
 		std::unordered_map<std::string, std::shared_ptr<Model>> modelCache_;
 		std::shared_ptr<Model> getModelCached_(const std::string& modelPath);
+		// Parses the models not cached yet in parallel, then uploads them
+		// and adds them to modelCache_.
+		void loadModels_(const std::vector<std::string>& modelPaths);
+
+		// --stream-models: a model being parsed or uploaded, and the
+		// objects that enter the scene once it is resident
+		struct StreamedModel {
+			std::future<std::unique_ptr<LoadedMesh>> mesh;
+			std::shared_ptr<Model> model;  // set once its upload is submitted
+			uint64_t uploadTicket = 0;
+			std::vector<SimObject> objects;
+		};
+		std::unordered_map<std::string, StreamedModel> streamedModels_;
+		std::unique_ptr<ThreadPool> modelLoader_;
+		void streamObject_(const std::string& modelPath, SimObject&& obj);
+		// Once per frame: uploads the models parsed since the last call and
+		// adds the objects of every model that became resident.
+		void pollStreamedModels_();
 
 		std::unique_ptr<DescriptorPool> globalPool{};
-		std::array<FrameCapture, SwapChain::MAX_FRAMES_IN_FLIGHT> captures;
-		SimObject::Map simObjects;
+		SceneStore sceneStore;
+		SceneBvh sceneBvh{ sceneStore };
 
 		VkImage shadowImage{VK_NULL_HANDLE};
-		VkDeviceMemory shadowImageMemory{VK_NULL_HANDLE};
+		DeviceAllocation shadowImageAllocation;
 		VkImageView shadowImageView{VK_NULL_HANDLE};
 		VkSampler shadowSampler{VK_NULL_HANDLE};
 
@@ -143,7 +243,7 @@ namespace cvsim {
 		VkExtent2D shadowExtent{2048, 2048};
 
 		VkImage skyboxImage{VK_NULL_HANDLE};
-		VkDeviceMemory skyboxImageMemory{VK_NULL_HANDLE};
+		DeviceAllocation skyboxImageAllocation;
 		VkImageView skyboxImageView{VK_NULL_HANDLE};
 		VkSampler skyboxSampler{VK_NULL_HANDLE};
 
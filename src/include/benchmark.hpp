@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvsim {
+
+	struct StressConfig;
+
+	// Contents of a --benchmark spec file:
+	// {
+	//   "scene": "../assets/scene_config.json",        optional
+	//   "stress": { "count": 50000, "spacing": 2.0,    optional, enables
+	//               "model": "..." },                  the stress scene
+	//   "gpuCulling": true, "instancing": true,        optional
+	//   "clusteredLighting": true,
+	//   "warmupFrames": 120,
+	//   "frames": 1000,
+	//   "dt": 0.0166667,                               simulation step
+	//   "camera": { "loop": false, "path": [
+	//       { "position": [x, y, z], "rotation": [x, y, z] }, ... ] },
+	//   "output": "benchmark_report.json"
+	// }
+	struct BenchmarkSpec {
+		struct PathPoint {
+			glm::vec3 position{ 0.f };
+			glm::vec3 rotation{ 0.f };
+		};
+
+		std::string path;
+		uint32_t warmupFrames = 120;
+		uint32_t frames = 1000;
+		float dt = 1.f / 60.f;
+		std::vector<PathPoint> cameraPath;
+		bool loopPath = false;
+		std::string outputPath = "benchmark_report.json";
+
+		// Reads the spec and applies its scene and render settings to cfg.
+		static BenchmarkSpec load(const std::string& specPath, StressConfig& cfg);
+	};
+
+	// Drives a benchmark run from the render loop: camera 0 follows a
+	// Catmull-Rom spline through the spec's path points (held at the start
+	// during warm-up), every frame is simulated with the fixed dt, and the
+	// measured frames are summarized into a JSON report.
+	class BenchmarkRun {
+	public:
+		struct FrameStats {
+			double cpuMs = 0.0;       // wall time of the whole loop iteration
+			uint32_t drawCalls = 0;   // scene draws, summed over all views
+			uint64_t visible = 0;     // objects drawn, summed over all views
+			uint64_t tested = 0;      // objects the culling behind visible was run on
+		};
+
+		// drainFrames: extra frames rendered after the measured ones so the
+		// GPU times of the last measured frames arrive.
+		BenchmarkRun(BenchmarkSpec spec, uint32_t drainFrames);
+
+		BenchmarkRun(const BenchmarkRun&) = delete;
+		BenchmarkRun& operator=(const BenchmarkRun&) = delete;
+
+		const BenchmarkSpec& getSpec() const { return spec; }
+
+		// Camera pose of the frame about to be rendered.
+		void cameraPose(glm::vec3& position, glm::vec3& rotation) const;
+
+		bool isMeasuring() const { return frame >= spec.warmupFrames && frame < measuredEnd(); }
+		bool isFinished() const { return frame >= measuredEnd() + drainFrames; }
+
+		// Once per rendered frame, after it was submitted; rendererFrame is
+		// Renderer::getFrameNumber() of that frame.
+		void endFrame(uint64_t rendererFrame, const FrameStats& stats);
+		// GPU time of renderer frame number rendererFrame (the GpuProfiler
+		// "frame" scope); counted if that frame was measured.
+		void addGpuFrameTime(uint64_t rendererFrame, double milliseconds);
+		// Same for the time of one GpuProfiler scope.
+		void addGpuScopeTime(uint64_t rendererFrame, const std::string& scope, double milliseconds);
+		// Any thread. Counted while measuring.
+		void addReadbackLatency(double milliseconds);
+
+		// Writes the report to the spec's output path and prints a summary.
+		void writeReport(const std::string& deviceName, uint64_t droppedCaptures) const;
+
+	private:
+		uint32_t measuredEnd() const { return spec.warmupFrames + spec.frames; }
+
+		BenchmarkSpec spec;
+		uint32_t drainFrames;
+		uint32_t frame = 0;
+
+		uint64_t firstMeasuredFrame = 0;
+		uint64_t lastMeasuredFrame = 0;
+		std::vector<double> cpuMs;
+		std::vector<double> gpuMs;
+		std::map<std::string, std::vector<double>> gpuScopeMs;
+		std::vector<double> drawCalls;
+		std::vector<double> visible;
+		std::vector<double> culled;
+
+		std::atomic<bool> measuring{ false };
+		mutable std::mutex latencyMutex;
+		std::vector<double> readbackMs;
+	};
+}
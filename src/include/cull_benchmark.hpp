@@ -0,0 +1,9 @@
+#pragma once
+
+namespace cvsim {
+
+	// Times the scalar isVisible() loop against the packed SIMD culling
+	// kernel at 10k/100k/1M spheres and prints the results. Needs no
+	// Vulkan device. Returns a process exit code.
+	int RunCullingBenchmark();
+}
@@ -2,27 +2,44 @@
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <geometry_msgs/msg/twist.hpp>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include "seqlock_mailbox.hpp"
+#include "cpu_tracer.hpp"
+#include <chrono>
 #include <thread>
-#include <mutex>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Plain copy of a geometry_msgs Twist (same field names, so it can be
+// passed wherever a Twist is) stamped when the subscription received it.
+struct CameraCommand {
+  struct Vector3 {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+  };
+  Vector3 linear;
+  Vector3 angular;
+  int64_t receiveTimeNs = 0;  // system clock, 0 if nothing was received
+  uint64_t sequence = 0;      // 1 for the first command on the topic
+};
 
 class RosImageBridge {
 public:
   RosImageBridge()
   {
     rclcpp::init(0, nullptr);
-    node_ = std::make_shared<rclcpp::Node>("vulkan_image_pub");
-    pub_ = node_->create_publisher<sensor_msgs::msg::Image>(
-      "/sim/image", 
-      rclcpp::SensorDataQoS()
-    );
-    sub_ = node_->create_subscription<geometry_msgs::msg::Twist>(
-      "/sim/camera_cmd", 10,
-      [this](geometry_msgs::msg::Twist::SharedPtr msg) {
-        std::lock_guard<std::mutex> lock(cmd_mutex_);
-        last_cmd_ = *msg;
-      });
+    // subscribers composed into this process get the published frames
+    // without serialization
+    node_ = std::make_shared<rclcpp::Node>(
+      "vulkan_image_pub", rclcpp::NodeOptions().use_intra_process_comms(true));
+    addImagePublisher("/sim/image", "sim_camera");
+    addCommandSubscription("/sim/camera_cmd");
     spin_ = std::thread([this]{
+      enginev::CpuTracer::setThreadName("ros executor");
       rclcpp::executors::SingleThreadedExecutor exec;
       exec.add_node(node_);
       exec.spin();
@@ -35,40 +52,139 @@ public:
     if (spin_.joinable()) spin_.join();
   }
 
+  // Publisher 0 is /sim/image; returns the index of the new publisher.
+  // Call before frames are published to it.
+  size_t addImagePublisher(const std::string& topic, const std::string& frameId)
+  {
+    ImagePublisher p;
+    p.pub = node_->create_publisher<sensor_msgs::msg::Image>(topic, rclcpp::SensorDataQoS());
+    p.frameId = frameId;
+    pubs_.push_back(std::move(p));
+    return pubs_.size() - 1;
+  }
+
   void publishBGRA8(uint32_t width, uint32_t height, const void* data, size_t bytes)
   {
-    auto msg = sensor_msgs::msg::Image();
-    msg.header.stamp = node_->get_clock()->now();
-    msg.header.frame_id = "sim_camera";
-    msg.width = width; 
-    msg.height = height;
-    msg.encoding = "bgra8";
-    msg.is_bigendian = false;
-    msg.step = width * 4;
-    msg.data.resize(bytes);
-    std::memcpy(msg.data.data(), data, bytes);
-    pub_->publish(std::move(msg));
+    publishBGRA8(width, height, data, bytes, node_->get_clock()->now());
   }
 
-  geometry_msgs::msg::Twist getLastCmd() {
-    std::lock_guard<std::mutex> lock(cmd_mutex_);
-    return last_cmd_;
+  // stamp: time the frame was rendered, not the time it is published
+  void publishBGRA8(uint32_t width, uint32_t height, const void* data, size_t bytes,
+                    const rclcpp::Time& stamp)
+  {
+    publishBGRA8(0, width, height, data, bytes, stamp);
   }
 
-  geometry_msgs::msg::Twist consumeLastCmd() {
-    std::lock_guard<std::mutex> lock(cmd_mutex_);
-    auto cmd = last_cmd_;
+  void publishBGRA8(size_t publisher, uint32_t width, uint32_t height, const void* data, size_t bytes,
+                    const rclcpp::Time& stamp)
+  {
+    publishImage(publisher, "bgra8", width, height, width * 4, data, bytes, stamp);
+  }
+
+  // encoding: sensor_msgs name; step: bytes per row, bytes: step * height
+  // The frame is copied once, from data (the mapped readback buffer) into
+  // the outgoing message, which is handed over by unique_ptr: subscribers
+  // in this process take ownership of it without another copy. Image is
+  // not a plain type, so it is never loaned. publish(const&) is avoided:
+  // with intra-process comms enabled it duplicates the message.
+  void publishImage(size_t publisher, const std::string& encoding, uint32_t width, uint32_t height,
+                    uint32_t step, const void* data, size_t bytes, const rclcpp::Time& stamp)
+  {
+    enginev::CpuTracer::Scope trace{ "RosImageBridge::publishImage", static_cast<int64_t>(publisher) };
+    const ImagePublisher& p = pubs_.at(publisher);
+
+    auto msg = std::make_unique<sensor_msgs::msg::Image>();
+    fillImage(*msg, p.frameId, encoding, width, height, step, data, bytes, stamp);
+    p.pub->publish(std::move(msg));
+  }
+
+  // Publishes one OK status with the given key/value pairs on
+  // /diagnostics. The publisher is created on the first call.
+  void publishDiagnostics(const std::string& name, const std::string& hardwareId,
+                          const std::vector<std::pair<std::string, std::string>>& values)
+  {
+    if (!diagnostics_) {
+      diagnostics_ = node_->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("/diagnostics", 10);
+    }
 
-    last_cmd_ = geometry_msgs::msg::Twist();
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = name;
+    status.hardware_id = hardwareId;
+    for (const auto& [key, value] : values) {
+      diagnostic_msgs::msg::KeyValue kv;
+      kv.key = key;
+      kv.value = value;
+      status.values.push_back(std::move(kv));
+    }
+
+    auto msg = std::make_unique<diagnostic_msgs::msg::DiagnosticArray>();
+    msg->header.stamp = node_->get_clock()->now();
+    msg->status.push_back(std::move(status));
+    diagnostics_->publish(std::move(msg));
+  }
+
+  // Subscription 0 is /sim/camera_cmd; returns the index of the new one.
+  // Call from the thread that reads the commands.
+  size_t addCommandSubscription(const std::string& topic)
+  {
+    auto mailbox = std::make_unique<SeqlockMailbox<CameraCommand>>();
+    SeqlockMailbox<CameraCommand>* box = mailbox.get();
+    // the single-threaded executor makes the callback the only writer
+    auto sub = node_->create_subscription<geometry_msgs::msg::Twist>(
+      topic, 10,
+      [box, sequence = uint64_t{0}](geometry_msgs::msg::Twist::SharedPtr msg) mutable {
+        CameraCommand cmd;
+        cmd.linear = { msg->linear.x, msg->linear.y, msg->linear.z };
+        cmd.angular = { msg->angular.x, msg->angular.y, msg->angular.z };
+        cmd.receiveTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count();
+        cmd.sequence = ++sequence;
+        box->store(cmd);
+      });
+    cmds_.push_back({ std::move(sub), std::move(mailbox) });
+    return cmds_.size() - 1;
+  }
+
+  // Latest command on the topic (all zero before the first one). Never
+  // blocks, so it is safe to call every frame on the render thread.
+  CameraCommand getLastCmd(size_t subscription = 0) const
+  {
+    CameraCommand cmd;
+    cmds_.at(subscription).mailbox->load(cmd);
     return cmd;
   }
 private:
+  struct ImagePublisher {
+    rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub;
+    std::string frameId;
+  };
+
+  struct CommandSubscription {
+    rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr sub;
+    std::unique_ptr<SeqlockMailbox<CameraCommand>> mailbox;
+  };
+
+  static void fillImage(sensor_msgs::msg::Image& msg, const std::string& frameId,
+                        const std::string& encoding, uint32_t width, uint32_t height,
+                        uint32_t step, const void* data, size_t bytes, const rclcpp::Time& stamp)
+  {
+    msg.header.stamp = stamp;
+    msg.header.frame_id = frameId;
+    msg.width = width;
+    msg.height = height;
+    msg.encoding = encoding;
+    msg.is_bigendian = false;
+    msg.step = step;
+    // assign() copies into the buffer without zero-filling it first
+    const auto* bytesIn = static_cast<const uint8_t*>(data);
+    msg.data.assign(bytesIn, bytesIn + bytes);
+  }
+
   std::shared_ptr<rclcpp::Node> node_;
-  rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub_;
-  rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr sub_;
+  std::vector<ImagePublisher> pubs_;
+  std::vector<CommandSubscription> cmds_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnostics_;
 
   std::thread spin_;
-
-  std::mutex cmd_mutex_;
-  geometry_msgs::msg::Twist last_cmd_;
 };
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-slot, single-writer mailbox that never blocks either side. The
+// writer bumps the sequence to an odd value, stores the payload and bumps
+// it back to even; a reader copies the payload and retries if the sequence
+// was odd or changed meanwhile. The payload is kept in relaxed atomic words,
+// so the racing copy is well defined. Readers only ever see the latest
+// value; older ones are overwritten.
+template <typename T>
+class SeqlockMailbox {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqlockMailbox needs a trivially copyable type");
+
+public:
+  SeqlockMailbox()
+  {
+    for (auto& word : words_) word.store(0, std::memory_order_relaxed);
+  }
+
+  SeqlockMailbox(const SeqlockMailbox&) = delete;
+  SeqlockMailbox& operator=(const SeqlockMailbox&) = delete;
+
+  // One writer at a time.
+  void store(const T& value)
+  {
+    Words in{};
+    std::memcpy(in.data(), &value, sizeof(T));
+
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORD_COUNT; ++i) {
+      words_[i].store(in[i], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Returns false while nothing has been stored yet.
+  bool load(T& value) const
+  {
+    Words out{};
+    uint64_t before = 0;
+    uint64_t after = 0;
+    do {
+      before = seq_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORD_COUNT; ++i) {
+        out[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = seq_.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    if (before == 0) return false;
+    std::memcpy(&value, out.data(), sizeof(T));
+    return true;
+  }
+
+private:
+  static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  using Words = std::array<uint64_t, WORD_COUNT>;
+
+  std::atomic<uint64_t> seq_{0};
+  std::array<std::atomic<uint64_t>, WORD_COUNT> words_;
+};
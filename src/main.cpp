@@ -1,15 +1,19 @@
 #include "app.hpp"
+#include "cull_benchmark.hpp"
 
+#include <cstdio>
 #include <iostream>
 #include <string>
 
 static void PrintUsage(const char* exe) {
     std::cout
         << "Usage:\n"
-        << "  " << exe << " [--stress] [--no-stress] [--stress-count N] [--stress-model PATH] [--stress-spacing S]\n\n"
+        << "  " << exe << " [--stress] [--no-stress] [--stress-count N] [--stress-model PATH] [--stress-spacing S] [--no-instancing] [--gpu-culling] [--no-clustered-lighting] [--headless] [--encoding bgra8|rgb8|mono8|yuv422] [--output-size WxH] [--depth 32FC1|16UC1] [--labels instance|semantic] [--benchmark SPEC.json] [--gpu-profile] [--gpu-diagnostics] [--trace OUT.json] [--stream-models]\n"
+        << "  " << exe << " --bench-culling\n\n"
         << "Examples:\n"
         << "  " << exe << " --stress\n"
         << "  " << exe << " --stress --stress-count 50000 --stress-spacing 1.0\n"
+        << "  " << exe << " --headless --benchmark ../assets/benchmark.json\n"
         << "  " << exe << " --scene <path> --stress --stress-model ../assets/models/tree1.obj\n";
 }
 
@@ -32,6 +36,61 @@ int main(int argc, char** argv) {
             cfg.scenePath = argv[++i];
             continue;
         }
+        else if (a == "--bench-culling") {
+            return cvsim::RunCullingBenchmark();
+        }
+        else if (a == "--no-instancing") {
+            cfg.instancing = false;
+        }
+        else if (a == "--gpu-culling") {
+            cfg.gpuCulling = true;
+        }
+        else if (a == "--no-clustered-lighting") {
+            cfg.clusteredLighting = false;
+        }
+        else if (a == "--headless") {
+            cfg.headless = true;
+        }
+        else if (a == "--encoding") {
+            if (i + 1 >= argc) { std::cerr << "--encoding requires a value\n"; return 2; }
+            cfg.imageEncoding = argv[++i];
+        }
+        else if (a == "--output-size") {
+            if (i + 1 >= argc) { std::cerr << "--output-size requires a value\n"; return 2; }
+            unsigned width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::cerr << "--output-size expects WxH, e.g. 640x480\n";
+                return 2;
+            }
+            cfg.outputWidth = width;
+            cfg.outputHeight = height;
+        }
+        else if (a == "--depth") {
+            if (i + 1 >= argc) { std::cerr << "--depth requires a value\n"; return 2; }
+            cfg.depthEncoding = argv[++i];
+        }
+        else if (a == "--benchmark") {
+            if (i + 1 >= argc) { std::cerr << "--benchmark requires a spec file\n"; return 2; }
+            cfg.benchmarkPath = argv[++i];
+        }
+        else if (a == "--gpu-profile") {
+            cfg.gpuProfile = true;
+        }
+        else if (a == "--gpu-diagnostics") {
+            cfg.gpuProfile = true;
+            cfg.gpuDiagnostics = true;
+        }
+        else if (a == "--trace") {
+            if (i + 1 >= argc) { std::cerr << "--trace requires an output file\n"; return 2; }
+            cfg.tracePath = argv[++i];
+        }
+        else if (a == "--stream-models") {
+            cfg.streamModels = true;
+        }
+        else if (a == "--labels") {
+            if (i + 1 >= argc) { std::cerr << "--labels requires a value\n"; return 2; }
+            cfg.labelMode = argv[++i];
+        }
         else if (a == "--stress") {
             cfg.enabled = true;
         }
@@ -30,11 +30,8 @@ namespace enginev {
         if (viewA) { vkDestroyImageView(device.device(), viewA, nullptr); viewA = VK_NULL_HANDLE; }
         if (viewB) { vkDestroyImageView(device.device(), viewB, nullptr); viewB = VK_NULL_HANDLE; }
 
-        if (imageA) { vkDestroyImage(device.device(), imageA, nullptr); imageA = VK_NULL_HANDLE; }
-        if (imageB) { vkDestroyImage(device.device(), imageB, nullptr); imageB = VK_NULL_HANDLE; }
-
-        if (memoryA) { vkFreeMemory(device.device(), memoryA, nullptr); memoryA = VK_NULL_HANDLE; }
-        if (memoryB) { vkFreeMemory(device.device(), memoryB, nullptr); memoryB = VK_NULL_HANDLE; }
+        if (imageA) { device.destroyImage(imageA, allocationA); }
+        if (imageB) { device.destroyImage(imageB, allocationB); }
 
         extent = { 0,0 };
     }
@@ -54,7 +51,7 @@ namespace enginev {
         createSamplers();
     }
 
-    void BloomPass::createImage(VkImage& img, VkDeviceMemory& mem) {
+    void BloomPass::createImage(VkImage& img, DeviceAllocation& alloc) {
         VkImageCreateInfo info{};
         info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         info.imageType = VK_IMAGE_TYPE_2D;
@@ -68,7 +65,7 @@ namespace enginev {
         info.samples = VK_SAMPLE_COUNT_1_BIT;
         info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-        device.createImageWithInfo(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, img, mem);
+        device.createImageWithInfo(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, img, alloc);
     }
 
     void BloomPass::createView(VkImage img, VkImageView& view) {
@@ -89,8 +86,8 @@ namespace enginev {
     }
 
     void BloomPass::createTargets() {
-        createImage(imageA, memoryA);
-        createImage(imageB, memoryB);
+        createImage(imageA, allocationA);
+        createImage(imageB, allocationB);
 
         createView(imageA, viewA);
         createView(imageB, viewB);
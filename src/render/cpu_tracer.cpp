@@ -0,0 +1,174 @@
+#include "cpu_tracer.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace enginev {
+
+    namespace {
+        // Single-writer ring. The owning thread bumps `claimed` before it
+        // overwrites a slot and `head` once the slot is complete; a reader
+        // copies up to `head`, then drops every slot that `claimed` says
+        // may have been reused while it was copying. Slot fields are
+        // relaxed atomics, so the racing copy is well defined.
+        struct Ring {
+            struct Slot {
+                std::atomic<const char*> name;
+                std::atomic<int64_t> startNs;
+                std::atomic<int64_t> durationNs;
+                std::atomic<int64_t> id;
+            };
+
+            std::unique_ptr<Slot[]> slots{ new Slot[CpuTracer::RING_CAPACITY] };
+            std::atomic<uint64_t> claimed{ 0 };
+            std::atomic<uint64_t> head{ 0 };
+            std::atomic<const char*> threadName{ nullptr };
+            uint32_t tid{ 0 };
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            // never freed: the events of a finished thread stay in the trace
+            std::vector<std::unique_ptr<Ring>> rings;
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        thread_local Ring* threadRing = nullptr;
+        thread_local const char* threadName = nullptr;
+
+        Ring& currentRing() {
+            if (!threadRing) {
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                reg.rings.push_back(std::make_unique<Ring>());
+                threadRing = reg.rings.back().get();
+                threadRing->tid = static_cast<uint32_t>(reg.rings.size());
+                threadRing->threadName.store(threadName, std::memory_order_relaxed);
+            }
+            return *threadRing;
+        }
+
+        struct Event {
+            const char* name;
+            int64_t startNs;
+            int64_t durationNs;
+            int64_t id;
+        };
+
+        // names are literals of this program, but keep the JSON valid anyway
+        void writeString(std::ostream& out, const char* text) {
+            out << '"';
+            for (const char* c = text; *c; ++c) {
+                if (*c == '"' || *c == '\\') out << '\\';
+                out << *c;
+            }
+            out << '"';
+        }
+    }
+
+    void CpuTracer::setThreadName(const char* name) {
+        threadName = name;
+        if (threadRing) {
+            threadRing->threadName.store(name, std::memory_order_relaxed);
+        }
+    }
+
+    int64_t CpuTracer::nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void CpuTracer::record(const char* name, int64_t startNs, int64_t endNs, int64_t id) {
+        Ring& ring = currentRing();
+        const uint64_t index = ring.head.load(std::memory_order_relaxed);
+
+        ring.claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Ring::Slot& slot = ring.slots[index % RING_CAPACITY];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.startNs.store(startNs, std::memory_order_relaxed);
+        slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+        slot.id.store(id, std::memory_order_relaxed);
+
+        ring.head.store(index + 1, std::memory_order_release);
+    }
+
+    bool CpuTracer::writeChromeTrace(const std::string& path) {
+        std::vector<Ring*> rings;
+        {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            for (auto& ring : reg.rings) rings.push_back(ring.get());
+        }
+
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        auto separator = [&] {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+
+        std::vector<Event> events;
+        events.reserve(RING_CAPACITY);
+        for (Ring* ring : rings) {
+            const uint64_t end = ring->head.load(std::memory_order_acquire);
+            const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+
+            events.clear();
+            for (uint64_t i = begin; i < end; ++i) {
+                const Ring::Slot& slot = ring->slots[i % RING_CAPACITY];
+                events.push_back({
+                    slot.name.load(std::memory_order_relaxed),
+                    slot.startNs.load(std::memory_order_relaxed),
+                    slot.durationNs.load(std::memory_order_relaxed),
+                    slot.id.load(std::memory_order_relaxed) });
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+            const uint64_t firstValid = claimed > RING_CAPACITY ? claimed - RING_CAPACITY : 0;
+
+            if (const char* name = ring->threadName.load(std::memory_order_relaxed)) {
+                separator();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+                    << ",\"args\":{\"name\":";
+                writeString(out, name);
+                out << "}}";
+            }
+
+            for (uint64_t i = std::max(begin, firstValid); i < end; ++i) {
+                const Event& e = events[static_cast<size_t>(i - begin)];
+                separator();
+                out << "{\"name\":";
+                writeString(out, e.name);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+                    << ",\"ts\":" << static_cast<double>(e.startNs) * 1e-3
+                    << ",\"dur\":" << static_cast<double>(e.durationNs) * 1e-3;
+                if (e.id >= 0) {
+                    out << ",\"args\":{\"id\":" << e.id << '}';
+                }
+                out << '}';
+            }
+        }
+
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+}
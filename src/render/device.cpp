@@ -155,24 +155,30 @@ namespace enginev {
         }
     }
 
-    Device::Device(Window& window) : window{ window } {
+    Device::Device(Window* window) : window{ window } {
         createInstance();
         setupDebugMessenger();
-        createSurface();
+        if (window) {
+            createSurface();
+        }
         pickPhysicalDevice();
         createLogicalDevice();
+        allocator_ = std::make_unique<DeviceAllocator>(device_, physicalDevice);
         createCommandPool();
     }
 
     Device::~Device() {
         vkDestroyCommandPool(device_, commandPool, nullptr);
+        allocator_.reset();
         vkDestroyDevice(device_, nullptr);
 
         if (enableValidationLayers) {
             DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(instance, surface_, nullptr);
+        if (surface_ != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface_, nullptr);
+        }
         vkDestroyInstance(instance, nullptr);
     }
 
@@ -246,7 +252,13 @@ namespace enginev {
         QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily };
+        if (indices.presentFamilyHasValue) {
+            uniqueQueueFamilies.insert(indices.presentFamily);
+        }
+        if (indices.transferFamilyHasValue) {
+            uniqueQueueFamilies.insert(indices.transferFamily);
+        }
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -272,8 +284,9 @@ namespace enginev {
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        auto extensions = getRequiredDeviceExtensions();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
 
         createInfo.pNext = &atomicFloatFeatures;
 
@@ -290,7 +303,20 @@ namespace enginev {
         }
 
         vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
-        vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+        if (indices.presentFamilyHasValue) {
+            vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+        }
+
+        graphicsFamily_ = indices.graphicsFamily;
+        if (indices.transferFamilyHasValue) {
+            transferFamily_ = indices.transferFamily;
+            vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+            std::cout << "transfer queue: family " << transferFamily_ << " (dedicated)" << std::endl;
+        } else {
+            transferFamily_ = indices.graphicsFamily;
+            transferQueue_ = graphicsQueue_;
+            std::cout << "transfer queue: graphics queue (no separate transfer family)" << std::endl;
+        }
     }
 
     void Device::createCommandPool() {
@@ -307,22 +333,27 @@ namespace enginev {
         }
     }
 
-    void Device::createSurface() { window.createWindowSurface(instance, &surface_); }
+    void Device::createSurface() { window->createWindowSurface(instance, &surface_); }
 
     bool Device::isDeviceSuitable(VkPhysicalDevice device) {
         QueueFamilyIndices indices = findQueueFamilies(device);
 
         bool extensionsSupported = checkDeviceExtensionSupport(device);
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+
+        if (isHeadless()) {
+            return indices.graphicsFamilyHasValue && extensionsSupported &&
+                supportedFeatures.samplerAnisotropy;
+        }
+
         bool swapChainAdequate = false;
         if (extensionsSupported) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
 
-        VkPhysicalDeviceFeatures supportedFeatures;
-        vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-
         return indices.isComplete() && extensionsSupported && swapChainAdequate &&
             supportedFeatures.samplerAnisotropy;
     }
@@ -375,11 +406,16 @@ namespace enginev {
     }
 
     std::vector<const char*> Device::getRequiredExtensions() {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        // GLFW is not initialized without a window and needs no surface
+        // extensions then
+        if (window) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -388,6 +424,13 @@ namespace enginev {
         return extensions;
     }
 
+    std::vector<const char*> Device::getRequiredDeviceExtensions() {
+        if (isHeadless()) {
+            return {};
+        }
+        return deviceExtensions;
+    }
+
     void Device::hasGflwRequiredInstanceExtensions() {
         uint32_t extensionCount = 0;
         vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
@@ -422,6 +465,7 @@ namespace enginev {
             &extensionCount,
             availableExtensions.data());
 
+        auto deviceExtensions = getRequiredDeviceExtensions();
         std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
         for (const auto& extension : availableExtensions) {
@@ -446,6 +490,13 @@ namespace enginev {
                 indices.graphicsFamily = i;
                 indices.graphicsFamilyHasValue = true;
             }
+            if (isHeadless()) {
+                if (indices.graphicsFamilyHasValue) {
+                    break;
+                }
+                i++;
+                continue;
+            }
             VkBool32 presentSupport = false;
             vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
             if (queueFamily.queueCount > 0 && presentSupport) {
@@ -459,9 +510,35 @@ namespace enginev {
             i++;
         }
 
+        // uploads run beside rendering on a family without graphics;
+        // a pure copy engine beats a compute family
+        for (uint32_t family = 0; family < queueFamilyCount; ++family) {
+            const VkQueueFlags flags = queueFamilies[family].queueFlags;
+            if (queueFamilies[family].queueCount == 0 ||
+                !(flags & VK_QUEUE_TRANSFER_BIT) ||
+                (flags & VK_QUEUE_GRAPHICS_BIT)) {
+                continue;
+            }
+            const bool copyOnly = !(flags & VK_QUEUE_COMPUTE_BIT);
+            if (!indices.transferFamilyHasValue || copyOnly) {
+                indices.transferFamily = family;
+                indices.transferFamilyHasValue = true;
+                if (copyOnly) break;
+            }
+        }
+
         return indices;
     }
 
+    VkQueueFamilyProperties Device::queueFamilyProperties(uint32_t family) {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        return queueFamilies.at(family);
+    }
+
     SwapChainSupportDetails Device::querySwapChainSupport(VkPhysicalDevice device) {
         SwapChainSupportDetails details;
         vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface_, &details.capabilities);
@@ -532,6 +609,36 @@ namespace enginev {
         vkBindBufferMemory(device_, buffer, bufferMemory, 0);
     }
 
+    void Device::createBuffer(
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags properties,
+        VkBuffer& buffer,
+        DeviceAllocation& allocation) {
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create vertex buffer!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
+
+        allocation = allocator_->allocate(
+            memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), true);
+        vkBindBufferMemory(device_, buffer, allocation.memory, allocation.offset);
+    }
+
+    void Device::destroyBuffer(VkBuffer& buffer, DeviceAllocation& allocation) {
+        vkDestroyBuffer(device_, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        allocator_->free(allocation);
+    }
+
     VkCommandBuffer Device::beginSingleTimeCommands() {
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -659,4 +766,32 @@ namespace enginev {
             throw std::runtime_error("failed to bind image memory!");
         }
     }
+
+    void Device::createImageWithInfo(
+        const VkImageCreateInfo& imageInfo,
+        VkMemoryPropertyFlags properties,
+        VkImage& image,
+        DeviceAllocation& allocation) {
+        if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device_, image, &memRequirements);
+
+        allocation = allocator_->allocate(
+            memRequirements,
+            findMemoryType(memRequirements.memoryTypeBits, properties),
+            imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
+
+        if (vkBindImageMemory(device_, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+            throw std::runtime_error("failed to bind image memory!");
+        }
+    }
+
+    void Device::destroyImage(VkImage& image, DeviceAllocation& allocation) {
+        vkDestroyImage(device_, image, nullptr);
+        image = VK_NULL_HANDLE;
+        allocator_->free(allocation);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "device_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        VkDeviceSize alignDown(VkDeviceSize value, VkDeviceSize alignment) {
+            return value / alignment * alignment;
+        }
+    }
+
+    bool DeviceAllocator::Block::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+        // smallest free range that still fits once aligned
+        for (auto it = freeBySize.lower_bound(size); it != freeBySize.end(); ++it) {
+            const VkDeviceSize rangeOffset = it->second;
+            const VkDeviceSize rangeSize = it->first;
+            const VkDeviceSize aligned = alignUp(rangeOffset, alignment);
+            if (aligned + size > rangeOffset + rangeSize) {
+                continue;
+            }
+
+            removeFreeRange(freeByOffset.find(rangeOffset));
+            if (aligned > rangeOffset) {
+                addFreeRange(rangeOffset, aligned - rangeOffset);
+            }
+            if (aligned + size < rangeOffset + rangeSize) {
+                addFreeRange(aligned + size, rangeOffset + rangeSize - (aligned + size));
+            }
+
+            offset = aligned;
+            ++allocationCount;
+            usedBytes += size;
+            return true;
+        }
+        return false;
+    }
+
+    void DeviceAllocator::Block::release(VkDeviceSize offset, VkDeviceSize size) {
+        --allocationCount;
+        usedBytes -= size;
+
+        // merge with the free neighbours on both sides
+        auto next = freeByOffset.lower_bound(offset);
+        if (next != freeByOffset.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                removeFreeRange(prev);
+            }
+        }
+        if (next != freeByOffset.end() && offset + size == next->first) {
+            size += next->second;
+            removeFreeRange(next);
+        }
+        addFreeRange(offset, size);
+    }
+
+    void DeviceAllocator::Block::addFreeRange(VkDeviceSize offset, VkDeviceSize size) {
+        freeByOffset.emplace(offset, size);
+        freeBySize.emplace(size, offset);
+    }
+
+    void DeviceAllocator::Block::removeFreeRange(std::map<VkDeviceSize, VkDeviceSize>::iterator range) {
+        auto [first, last] = freeBySize.equal_range(range->second);
+        for (auto it = first; it != last; ++it) {
+            if (it->second == range->first) {
+                freeBySize.erase(it);
+                break;
+            }
+        }
+        freeByOffset.erase(range);
+    }
+
+    DeviceAllocator::DeviceAllocator(VkDevice device, VkPhysicalDevice physicalDevice)
+        : device{ device } {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        nonCoherentAtomSize = std::max<VkDeviceSize>(1, properties.limits.nonCoherentAtomSize);
+
+        pools.resize(2 * memoryProperties.memoryTypeCount);
+        for (uint32_t i = 0; i < pools.size(); ++i) {
+            Pool& pool = pools[i];
+            pool.memoryType = i / 2;
+            // small heaps (e.g. the 256 MB BAR window) get smaller blocks
+            const VkDeviceSize heapSize =
+                memoryProperties.memoryHeaps[memoryProperties.memoryTypes[pool.memoryType].heapIndex].size;
+            pool.blockSize = std::min(BLOCK_SIZE, alignDown(heapSize / 8, nonCoherentAtomSize));
+        }
+    }
+
+    DeviceAllocator::~DeviceAllocator() {
+        for (Pool& pool : pools) {
+            for (auto& block : pool.blocks) {
+                vkFreeMemory(device, block->memory, nullptr);
+            }
+        }
+    }
+
+    bool DeviceAllocator::isHostVisible(uint32_t memoryType) const {
+        return (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    }
+
+    VkDeviceMemory DeviceAllocator::allocateMemory(uint32_t memoryType, VkDeviceSize size, void*& mapped) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryType;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate device memory!");
+        }
+
+        mapped = nullptr;
+        if (isHostVisible(memoryType) &&
+            vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+            vkFreeMemory(device, memory, nullptr);
+            throw std::runtime_error("failed to map device memory!");
+        }
+        return memory;
+    }
+
+    DeviceAllocation DeviceAllocator::allocate(
+        const VkMemoryRequirements& requirements, uint32_t memoryType, bool linear) {
+        VkDeviceSize size = requirements.size;
+        VkDeviceSize alignment = std::max<VkDeviceSize>(1, requirements.alignment);
+        if (isHostVisible(memoryType)) {
+            // keeps every flush/invalidate range inside the allocation
+            size = alignUp(size, nonCoherentAtomSize);
+            alignment = alignUp(alignment, nonCoherentAtomSize);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        DeviceAllocation allocation;
+        allocation.pool = 2 * memoryType + (linear ? 0 : 1);
+        allocation.size = size;
+        Pool& pool = pools[allocation.pool];
+
+        if (size > pool.blockSize / 2) {
+            allocation.memory = allocateMemory(memoryType, size, allocation.mapped);
+            allocation.dedicated = true;
+            ++dedicatedCount;
+            dedicatedBytes += size;
+            return allocation;
+        }
+
+        Block* target = nullptr;
+        for (auto& block : pool.blocks) {
+            if (block->allocate(size, alignment, allocation.offset)) {
+                target = block.get();
+                break;
+            }
+        }
+        if (!target) {
+            auto block = std::make_unique<Block>();
+            block->capacity = pool.blockSize;
+            block->memory = allocateMemory(memoryType, block->capacity, block->mapped);
+            block->addFreeRange(0, block->capacity);
+            target = block.get();
+            pool.blocks.push_back(std::move(block));
+
+            const bool fits = target->allocate(size, alignment, allocation.offset);
+            assert(fits && "allocation does not fit an empty block");
+            (void)fits;
+        }
+
+        allocation.memory = target->memory;
+        if (target->mapped) {
+            allocation.mapped = static_cast<char*>(target->mapped) + allocation.offset;
+        }
+        return allocation;
+    }
+
+    void DeviceAllocator::free(DeviceAllocation& allocation) {
+        if (!allocation) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (allocation.dedicated) {
+            vkFreeMemory(device, allocation.memory, nullptr);
+            --dedicatedCount;
+            dedicatedBytes -= allocation.size;
+            allocation = DeviceAllocation{};
+            return;
+        }
+
+        Pool& pool = pools[allocation.pool];
+        auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+            [&](const std::unique_ptr<Block>& block) { return block->memory == allocation.memory; });
+        assert(it != pool.blocks.end() && "allocation is not from this allocator");
+
+        Block& block = **it;
+        block.release(allocation.offset, allocation.size);
+        // an empty block goes back to the driver, unless it is the last one
+        // of its pool: resize-heavy passes would just allocate it again
+        if (block.allocationCount == 0 && pool.blocks.size() > 1) {
+            vkFreeMemory(device, block.memory, nullptr);
+            pool.blocks.erase(it);
+        }
+        allocation = DeviceAllocation{};
+    }
+
+    VkMappedMemoryRange DeviceAllocator::mappedRange(
+        const DeviceAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const {
+        if (size == VK_WHOLE_SIZE) {
+            size = allocation.size - offset;
+        }
+
+        // allocations of host-visible memory start and end on atom boundaries
+        const VkDeviceSize begin = alignDown(allocation.offset + offset, nonCoherentAtomSize);
+        const VkDeviceSize end = std::min(
+            alignUp(allocation.offset + offset + size, nonCoherentAtomSize),
+            allocation.offset + allocation.size);
+
+        VkMappedMemoryRange range{};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = allocation.memory;
+        range.offset = begin;
+        range.size = end - begin;
+        return range;
+    }
+
+    DeviceAllocator::Stats DeviceAllocator::getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Stats stats;
+        VkDeviceSize freeBytes = 0;
+        VkDeviceSize largestRangesBytes = 0;
+        for (const Pool& pool : pools) {
+            for (const auto& block : pool.blocks) {
+                ++stats.blockCount;
+                stats.blockBytes += block->capacity;
+                stats.allocationCount += block->allocationCount;
+                stats.usedBytes += block->usedBytes;
+                stats.freeRangeCount += static_cast<uint32_t>(block->freeByOffset.size());
+                for (const auto& range : block->freeByOffset) {
+                    freeBytes += range.second;
+                }
+                if (!block->freeBySize.empty()) {
+                    const VkDeviceSize largest = block->freeBySize.rbegin()->first;
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, largest);
+                    largestRangesBytes += largest;
+                }
+            }
+        }
+        if (freeBytes > 0) {
+            stats.fragmentation = 1.f - static_cast<float>(largestRangesBytes) / static_cast<float>(freeBytes);
+        }
+        stats.dedicatedCount = dedicatedCount;
+        stats.dedicatedBytes = dedicatedBytes;
+        return stats;
+    }
+}
@@ -0,0 +1,199 @@
+#include "frustum_cull.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CULL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CULL_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CULL_SSE 1
+#endif
+
+// AVX2 is used when the whole build targets it, or, on GCC/Clang, through a
+// per-function target attribute selected at runtime.
+#if defined(CULL_X86) && defined(__AVX2__)
+#define CULL_AVX2 1
+#define CULL_AVX2_TARGET
+#elif defined(CULL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CULL_AVX2 1
+#define CULL_AVX2_RUNTIME 1
+#define CULL_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace enginev {
+
+    namespace {
+
+        inline uint32_t countTrailingZeros(uint32_t v) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, v);
+            return static_cast<uint32_t>(index);
+#else
+            return static_cast<uint32_t>(__builtin_ctz(v));
+#endif
+        }
+
+        inline size_t emitMask(uint32_t mask, uint32_t base, uint32_t* out) {
+            size_t n = 0;
+            while (mask) {
+                out[n++] = base + countTrailingZeros(mask);
+                mask &= mask - 1;
+            }
+            return n;
+        }
+
+        inline bool sphereVisible(const Frustum& f, float x, float y, float z, float r) {
+            for (int p = 0; p < 6; ++p) {
+                const glm::vec4& pl = f.planes[p];
+                if (pl.x * x + pl.y * y + pl.z * z + pl.w < -r) return false;
+            }
+            return true;
+        }
+
+        size_t cullTailScalar(
+            const Frustum& f,
+            const float* xs, const float* ys, const float* zs, const float* rs,
+            size_t begin, size_t count, uint32_t* out, uint32_t indexBase) {
+            size_t n = 0;
+            for (size_t i = begin; i < count; ++i) {
+                if (sphereVisible(f, xs[i], ys[i], zs[i], rs[i])) {
+                    out[n++] = indexBase + static_cast<uint32_t>(i);
+                }
+            }
+            return n;
+        }
+
+#if defined(CULL_SSE)
+        size_t cullSpheresSse(
+            const Frustum& f,
+            const float* xs, const float* ys, const float* zs, const float* rs,
+            size_t count, uint32_t* out, uint32_t indexBase) {
+            __m128 px[6], py[6], pz[6], pw[6];
+            for (int p = 0; p < 6; ++p) {
+                px[p] = _mm_set1_ps(f.planes[p].x);
+                py[p] = _mm_set1_ps(f.planes[p].y);
+                pz[p] = _mm_set1_ps(f.planes[p].z);
+                pw[p] = _mm_set1_ps(f.planes[p].w);
+            }
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+
+            size_t n = 0;
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128 x = _mm_loadu_ps(xs + i);
+                const __m128 y = _mm_loadu_ps(ys + i);
+                const __m128 z = _mm_loadu_ps(zs + i);
+                const __m128 negR = _mm_xor_ps(_mm_loadu_ps(rs + i), signBit);
+
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int p = 0; p < 6; ++p) {
+                    __m128 d = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)),
+                        _mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+                }
+
+                const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+                n += emitMask(mask, indexBase + static_cast<uint32_t>(i), out + n);
+            }
+
+            return n + cullTailScalar(f, xs, ys, zs, rs, i, count, out + n, indexBase);
+        }
+#endif
+
+#if defined(CULL_AVX2)
+        CULL_AVX2_TARGET
+        size_t cullSpheresAvx2(
+            const Frustum& f,
+            const float* xs, const float* ys, const float* zs, const float* rs,
+            size_t count, uint32_t* out, uint32_t indexBase) {
+            __m256 px[6], py[6], pz[6], pw[6];
+            for (int p = 0; p < 6; ++p) {
+                px[p] = _mm256_set1_ps(f.planes[p].x);
+                py[p] = _mm256_set1_ps(f.planes[p].y);
+                pz[p] = _mm256_set1_ps(f.planes[p].z);
+                pw[p] = _mm256_set1_ps(f.planes[p].w);
+            }
+            const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+            size_t n = 0;
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 x = _mm256_loadu_ps(xs + i);
+                const __m256 y = _mm256_loadu_ps(ys + i);
+                const __m256 z = _mm256_loadu_ps(zs + i);
+                const __m256 negR = _mm256_xor_ps(_mm256_loadu_ps(rs + i), signBit);
+
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < 6; ++p) {
+                    __m256 d = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)),
+                        _mm256_add_ps(_mm256_mul_ps(pz[p], z), pw[p]));
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+                }
+
+                const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+                n += emitMask(mask, indexBase + static_cast<uint32_t>(i), out + n);
+            }
+
+            return n + cullTailScalar(f, xs, ys, zs, rs, i, count, out + n, indexBase);
+        }
+#endif
+
+        using CullFn = size_t (*)(
+            const Frustum&, const float*, const float*, const float*, const float*,
+            size_t, uint32_t*, uint32_t);
+
+        struct CullKernel {
+            CullFn fn;
+            const char* name;
+        };
+
+        CullKernel selectKernel() {
+#if defined(CULL_AVX2_RUNTIME)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return { cullSpheresAvx2, "avx2" };
+            }
+#elif defined(CULL_AVX2)
+            return { cullSpheresAvx2, "avx2" };
+#endif
+#if defined(CULL_SSE)
+            return { cullSpheresSse, "sse" };
+#else
+            return { cullSpheresScalar, "scalar" };
+#endif
+        }
+
+        const CullKernel& kernel() {
+            static const CullKernel k = selectKernel();
+            return k;
+        }
+    }
+
+    size_t cullSpheresScalar(
+        const Frustum& frustum,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        size_t count,
+        uint32_t* outIndices,
+        uint32_t indexBase) {
+        return cullTailScalar(frustum, xs, ys, zs, radii, 0, count, outIndices, indexBase);
+    }
+
+    size_t cullSpheres(
+        const Frustum& frustum,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        size_t count,
+        uint32_t* outIndices,
+        uint32_t indexBase) {
+        return kernel().fn(frustum, xs, ys, zs, radii, count, outIndices, indexBase);
+    }
+
+    const char* cullKernelName() {
+        return kernel().name;
+    }
+}
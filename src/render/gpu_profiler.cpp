@@ -0,0 +1,204 @@
+#include "gpu_profiler.hpp"
+
+#include "swap_chain.hpp"
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace enginev {
+
+    GpuProfiler::GpuProfiler(Device& device) : device{ device } {
+        registerScope("frame");
+    }
+
+    GpuProfiler::~GpuProfiler() {
+        for (auto& slot : slots) {
+            vkDestroyQueryPool(device.device(), slot.pool, nullptr);
+        }
+    }
+
+    bool GpuProfiler::enable() {
+        if (isEnabled()) {
+            return true;
+        }
+
+        const uint32_t validBits =
+            device.queueFamilyProperties(device.findPhysicalQueueFamilies().graphicsFamily).timestampValidBits;
+        if (validBits == 0) {
+            return false;
+        }
+        timestampMask = validBits >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << validBits) - 1;
+
+        // the pools are created, and grown with the registered scopes, by
+        // beginFrame()
+        slots.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        return true;
+    }
+
+    void GpuProfiler::createPool(FrameSlot& slot, uint32_t queryCapacity) {
+        if (slot.pool) {
+            vkDestroyQueryPool(device.device(), slot.pool, nullptr);
+            slot.pool = VK_NULL_HANDLE;
+        }
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = queryCapacity;
+        if (vkCreateQueryPool(device.device(), &poolInfo, nullptr, &slot.pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create profiler query pool!");
+        }
+        slot.queryCapacity = queryCapacity;
+        slot.records.reserve(queryCapacity / 2);
+        if (results.size() < queryCapacity) {
+            results.resize(queryCapacity);
+        }
+    }
+
+    uint32_t GpuProfiler::registerScope(const std::string& name) {
+        for (size_t i = 0; i < scopes.size(); ++i) {
+            if (scopes[i].name == name) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+
+        Scope scope;
+        scope.name = name;
+        scope.samples.resize(AVERAGE_WINDOW);
+        scopes.push_back(std::move(scope));
+        return static_cast<uint32_t>(scopes.size() - 1);
+    }
+
+    void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, int frameIndex, uint64_t frameNumber) {
+        if (!isEnabled()) {
+            return;
+        }
+
+        current = &slots[static_cast<size_t>(frameIndex)];
+        collect(*current);
+
+        // the frame that used this pool has completed, it can be replaced
+        const uint32_t queryCapacity =
+            2 * std::max(MIN_SCOPES_PER_FRAME, 2 * static_cast<uint32_t>(scopes.size()));
+        if (current->queryCapacity < queryCapacity) {
+            createPool(*current, queryCapacity);
+        }
+
+        vkCmdResetQueryPool(commandBuffer, current->pool, 0, current->queryCapacity);
+        current->frameNumber = frameNumber;
+
+        // nothing is recorded before it, TOP_OF_PIPE is the start of the
+        // command buffer rather than the end of the previous one
+        current->queryCount = 1;
+        current->reservedQueries = 1;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, current->pool, 0);
+        current->records.push_back({ FRAME_SCOPE, 0, NO_QUERY });
+    }
+
+    void GpuProfiler::endFrame(VkCommandBuffer commandBuffer) {
+        endScope(commandBuffer, FRAME_SCOPE);
+    }
+
+    void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+        if (!current) {
+            return;
+        }
+        // the begin query and this scope's end query, on top of the end
+        // queries of the scopes still open around it
+        if (current->queryCount + current->reservedQueries + 2 > current->queryCapacity) {
+            if (!droppedScopeReported) {
+                droppedScopeReported = true;
+                std::cerr << "[PROFILE] more than " << current->queryCapacity / 2
+                    << " scopes in one frame, the ones past that are not timed\n";
+            }
+            return;
+        }
+
+        const uint32_t query = current->queryCount++;
+        ++current->reservedQueries;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current->pool, query);
+        current->records.push_back({ scope, query, NO_QUERY });
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+        if (!current) {
+            return;
+        }
+
+        // the end query is only taken here, from the room beginScope()
+        // reserved, so the queries of the frame have no gaps and the
+        // results never come back incomplete
+        for (auto it = current->records.rbegin(); it != current->records.rend(); ++it) {
+            if (it->scope == scope && it->endQuery == NO_QUERY) {
+                --current->reservedQueries;
+                it->endQuery = current->queryCount++;
+                vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, current->pool, it->endQuery);
+                return;
+            }
+        }
+    }
+
+    void GpuProfiler::collect(FrameSlot& slot) {
+        if (slot.frameNumber != 0 && slot.queryCount != 0 &&
+            vkGetQueryPoolResults(
+                device.device(),
+                slot.pool,
+                0,
+                slot.queryCount,
+                sizeof(uint64_t) * slot.queryCount,
+                results.data(),
+                sizeof(uint64_t),
+                VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            const double msPerTick = device.properties.limits.timestampPeriod * 1e-6;
+
+            frameScopeMs.assign(scopes.size(), -1.0);
+            for (const Record& record : slot.records) {
+                if (record.endQuery == NO_QUERY) {
+                    continue;
+                }
+                const uint64_t ticks = (results[record.endQuery] - results[record.beginQuery]) & timestampMask;
+                double& ms = frameScopeMs[record.scope];
+                ms = std::max(ms, 0.0) + static_cast<double>(ticks) * msPerTick;
+            }
+
+            lastFrame.frameNumber = slot.frameNumber;
+            lastFrame.scopes.clear();
+            for (size_t i = 0; i < scopes.size(); ++i) {
+                if (frameScopeMs[i] >= 0.0) {
+                    addSample(scopes[i], frameScopeMs[i]);
+                    lastFrame.scopes.emplace_back(static_cast<uint32_t>(i), frameScopeMs[i]);
+                }
+            }
+        }
+
+        slot.frameNumber = 0;
+        slot.queryCount = 0;
+        slot.reservedQueries = 0;
+        slot.records.clear();
+    }
+
+    void GpuProfiler::addSample(Scope& scope, double milliseconds) {
+        if (scope.count == AVERAGE_WINDOW) {
+            scope.sum -= scope.samples[scope.next];
+        } else {
+            ++scope.count;
+        }
+        scope.samples[scope.next] = milliseconds;
+        scope.sum += milliseconds;
+        scope.next = (scope.next + 1) % AVERAGE_WINDOW;
+        scope.last = milliseconds;
+    }
+
+    std::vector<GpuProfiler::ScopeTiming> GpuProfiler::getTimings() const {
+        std::vector<ScopeTiming> timings;
+        for (const Scope& scope : scopes) {
+            if (scope.count == 0) {
+                continue;
+            }
+            timings.push_back({ scope.name, scope.sum / static_cast<double>(scope.count), scope.last });
+        }
+        return timings;
+    }
+}
@@ -50,7 +50,7 @@ private:
     void createFramebuffers();
     void createSamplers();
 
-    void createImage(VkImage& img, VkDeviceMemory& mem);
+    void createImage(VkImage& img, DeviceAllocation& alloc);
     void createView(VkImage img, VkImageView& view);
 
 private:
@@ -62,12 +62,12 @@ private:
     const VkFormat bloomFormat = VK_FORMAT_R8G8B8A8_UNORM;
 
     VkImage imageA{VK_NULL_HANDLE};
-    VkDeviceMemory memoryA{VK_NULL_HANDLE};
+    DeviceAllocation allocationA;
     VkImageView viewA{VK_NULL_HANDLE};
     VkSampler samplerA{VK_NULL_HANDLE};
 
     VkImage imageB{VK_NULL_HANDLE};
-    VkDeviceMemory memoryB{VK_NULL_HANDLE};
+    DeviceAllocation allocationB;
     VkImageView viewB{VK_NULL_HANDLE};
     VkSampler samplerB{VK_NULL_HANDLE};
 
@@ -46,7 +46,7 @@ namespace enginev {
         Device& device;
         void* mapped = nullptr;
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        DeviceAllocation allocation;
 
         VkDeviceSize bufferSize;
         uint32_t instanceCount;
@@ -0,0 +1,57 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace enginev {
+
+    // Scoped CPU timing, exported in the Chrome trace_event format
+    // (chrome://tracing, ui.perfetto.dev). Every thread records into its
+    // own fixed-size ring without locks, overwriting its oldest events;
+    // writeChromeTrace() copies whatever the rings hold at that moment.
+    // While tracing is disabled a Scope costs one relaxed atomic load.
+    class CpuTracer {
+    public:
+        static constexpr size_t RING_CAPACITY = size_t{ 1 } << 16;  // events per thread
+
+        class Scope {
+        public:
+            // name must stay valid until the trace is written (use a
+            // literal); id is shown as the event's argument if >= 0
+            explicit Scope(const char* name, int64_t id = -1)
+                : name{ name }, id{ id }, startNs{ CpuTracer::isEnabled() ? CpuTracer::nowNs() : 0 } {}
+            ~Scope() {
+                if (startNs != 0) {
+                    CpuTracer::record(name, startNs, CpuTracer::nowNs(), id);
+                }
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+            int64_t id;
+            int64_t startNs;
+        };
+
+        static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+        // Name of the calling thread in the trace (a literal as well).
+        static void setThreadName(const char* name);
+
+        static int64_t nowNs();
+        static void record(const char* name, int64_t startNs, int64_t endNs, int64_t id = -1);
+
+        // Any thread, while the others keep recording. Returns false if
+        // the file cannot be written.
+        static bool writeChromeTrace(const std::string& path);
+
+    private:
+        static inline std::atomic<bool> enabled{ false };
+    };
+}
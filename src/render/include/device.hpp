@@ -1,7 +1,9 @@
 #pragma once
 
 #include "window.hpp"
+#include "device_allocator.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +20,9 @@ namespace enginev {
 		uint32_t presentFamily;
 		bool graphicsFamilyHasValue = false;
 		bool presentFamilyHasValue = false;
+		// a family without graphics (usually the DMA engines), if any
+		uint32_t transferFamily;
+		bool transferFamilyHasValue = false;
 		bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 	};
 
@@ -29,7 +34,11 @@ namespace enginev {
 		const bool enableValidationLayers = true;
 #endif
 
-		Device(Window& window);
+		Device(Window& window) : Device(&window) {}
+		// window == nullptr creates a headless device: no surface, no
+		// present queue and no swap chain extension, any GPU (or software
+		// rasterizer such as lavapipe) with a graphics queue will do.
+		explicit Device(Window* window);
 		~Device();
 
 		Device(const Device&) = delete;
@@ -42,10 +51,19 @@ namespace enginev {
 		VkSurfaceKHR surface() { return surface_; }
 		VkQueue graphicsQueue() { return graphicsQueue_; }
 		VkQueue presentQueue() { return presentQueue_; }
+		// The dedicated transfer queue, or the graphics queue when the GPU
+		// has no family without graphics; resources moving between the two
+		// families need an ownership transfer (see UploadBatcher).
+		VkQueue transferQueue() { return transferQueue_; }
+		uint32_t graphicsQueueFamily() const { return graphicsFamily_; }
+		uint32_t transferQueueFamily() const { return transferFamily_; }
+		bool hasDedicatedTransferQueue() const { return transferFamily_ != graphicsFamily_; }
+		bool isHeadless() const { return window == nullptr; }
 
 		SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
 		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 		QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
+		VkQueueFamilyProperties queueFamilyProperties(uint32_t family);
 		VkFormat findSupportedFormat(
 			const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
@@ -56,6 +74,15 @@ namespace enginev {
 			VkMemoryPropertyFlags properties,
 			VkBuffer& buffer,
 			VkDeviceMemory& bufferMemory);
+		// Sub-allocated from the device's DeviceAllocator; host-visible
+		// memory comes back mapped (allocation.mapped).
+		void createBuffer(
+			VkDeviceSize size,
+			VkBufferUsageFlags usage,
+			VkMemoryPropertyFlags properties,
+			VkBuffer& buffer,
+			DeviceAllocation& allocation);
+		void destroyBuffer(VkBuffer& buffer, DeviceAllocation& allocation);
 		VkCommandBuffer beginSingleTimeCommands();
 		void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 		void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -67,6 +94,13 @@ namespace enginev {
 			VkMemoryPropertyFlags properties,
 			VkImage& image,
 			VkDeviceMemory& imageMemory);
+		void createImageWithInfo(
+			const VkImageCreateInfo& imageInfo,
+			VkMemoryPropertyFlags properties,
+			VkImage& image,
+			DeviceAllocation& allocation);
+		void destroyImage(VkImage& image, DeviceAllocation& allocation);
+		DeviceAllocator& getAllocator() { return *allocator_; }
 
 		void transitionImageLayout(
 			VkImage image,
@@ -86,6 +120,7 @@ namespace enginev {
 		// helper functions
 		bool isDeviceSuitable(VkPhysicalDevice device);
 		std::vector<const char*> getRequiredExtensions();
+		std::vector<const char*> getRequiredDeviceExtensions();
 		bool checkValidationLayerSupport();
 		QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
 		void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
@@ -100,13 +135,17 @@ namespace enginev {
 		VkInstance instance;
 		VkDebugUtilsMessengerEXT debugMessenger;
 		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-		Window& window;
+		Window* window;
 		VkCommandPool commandPool;
 
 		VkDevice device_;
-		VkSurfaceKHR surface_;
+		VkSurfaceKHR surface_ = VK_NULL_HANDLE;
 		VkQueue graphicsQueue_;
-		VkQueue presentQueue_;
+		VkQueue presentQueue_ = VK_NULL_HANDLE;
+		VkQueue transferQueue_ = VK_NULL_HANDLE;
+		uint32_t graphicsFamily_ = 0;
+		uint32_t transferFamily_ = 0;
+		std::unique_ptr<DeviceAllocator> allocator_;
 
 		const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
 		const std::vector<const char*> deviceExtensions = { 
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace enginev {
+
+    // A range of VkDeviceMemory handed out by DeviceAllocator. Host-visible
+    // memory stays mapped while its block lives; mapped points at offset.
+    struct DeviceAllocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void* mapped = nullptr;
+
+        explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+
+    private:
+        friend class DeviceAllocator;
+        uint32_t pool = 0;
+        bool dedicated = false;
+    };
+
+    // Sub-allocates buffers and images from large VkDeviceMemory blocks, one
+    // list of blocks per memory type, instead of one vkAllocateMemory per
+    // resource. Inside a block the free ranges are kept by offset (to merge
+    // neighbours on free) and by size (best fit on allocate). Buffers and
+    // optimal-tiling images never share a block, so bufferImageGranularity
+    // does not apply. Requests over half a block get memory of their own.
+    class DeviceAllocator {
+    public:
+        static constexpr VkDeviceSize BLOCK_SIZE = 64 * 1024 * 1024;
+
+        struct Stats {
+            uint32_t blockCount = 0;
+            VkDeviceSize blockBytes = 0;
+            uint32_t allocationCount = 0;  // sub-allocations in the blocks
+            VkDeviceSize usedBytes = 0;    // of blockBytes, alignment padding excluded
+            uint32_t freeRangeCount = 0;
+            VkDeviceSize largestFreeRange = 0;
+            uint32_t dedicatedCount = 0;
+            VkDeviceSize dedicatedBytes = 0;
+            // 1 - (sum of the largest free range of each block) / (sum of all
+            // free ranges):
+            // 0 while the free space of every block is one range, towards 1
+            // as it splinters into ranges too small to be useful
+            float fragmentation = 0.f;
+        };
+
+        DeviceAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+        ~DeviceAllocator();
+
+        DeviceAllocator(const DeviceAllocator&) = delete;
+        DeviceAllocator& operator=(const DeviceAllocator&) = delete;
+
+        // linear: a buffer or a linear-tiling image
+        DeviceAllocation allocate(const VkMemoryRequirements& requirements, uint32_t memoryType, bool linear);
+        void free(DeviceAllocation& allocation);
+
+        // The flush/invalidate range of [offset, offset + size) inside
+        // allocation, widened to nonCoherentAtomSize.
+        VkMappedMemoryRange mappedRange(
+            const DeviceAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+        Stats getStats() const;
+
+    private:
+        struct Block {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize capacity = 0;
+            void* mapped = nullptr;
+            uint32_t allocationCount = 0;
+            VkDeviceSize usedBytes = 0;
+            std::map<VkDeviceSize, VkDeviceSize> freeByOffset;       // offset -> size
+            std::multimap<VkDeviceSize, VkDeviceSize> freeBySize;    // size -> offset
+
+            bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+            void release(VkDeviceSize offset, VkDeviceSize size);
+            void addFreeRange(VkDeviceSize offset, VkDeviceSize size);
+            void removeFreeRange(std::map<VkDeviceSize, VkDeviceSize>::iterator range);
+        };
+
+        struct Pool {
+            uint32_t memoryType = 0;
+            VkDeviceSize blockSize = 0;
+            std::vector<std::unique_ptr<Block>> blocks;
+        };
+
+        // Allocates and, if host visible, maps size bytes of memoryType.
+        VkDeviceMemory allocateMemory(uint32_t memoryType, VkDeviceSize size, void*& mapped);
+        bool isHostVisible(uint32_t memoryType) const;
+
+        VkDevice device;
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        VkDeviceSize nonCoherentAtomSize = 1;
+
+        mutable std::mutex mutex;
+        // two per memory type: [2 * type] linear, [2 * type + 1] optimal
+        std::vector<Pool> pools;
+        uint32_t dedicatedCount = 0;
+        VkDeviceSize dedicatedBytes = 0;
+    };
+}
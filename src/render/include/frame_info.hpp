@@ -2,6 +2,8 @@
 
 #include "camera.hpp"
 #include "object.hpp"
+#include "scene_store.hpp"
+#include "scene_bvh.hpp"
 #include "frustum.hpp"
 
 // lib
@@ -10,8 +12,6 @@
 
 namespace enginev {
 
-	#define MAX_LIGHTS 400
-
 	struct BrightPushConstant {
 		float threshold = 1.0f;
 		float knee      = 0.5f;
@@ -41,6 +41,7 @@ namespace enginev {
 	static_assert(sizeof(BrightPushConstant) == 16, "BrightPushConstant size must match shader");
 
 
+	// element of the point light storage buffer (global set, binding 3)
 	struct PointLight {
 		glm::vec4 position{};
 		glm::vec4 color{};
@@ -60,13 +61,18 @@ namespace enginev {
 		alignas(16) glm::vec4 sunParams{0.f, 0.f, 0.f, 0.f};
 		alignas(16) glm::vec4 sunScreen{0.5f, 0.5f, 0.f, 1.f};
 
-		alignas(16) PointLight pointLights[MAX_LIGHTS];
-		alignas(16) int numLights{0};
-
-		alignas(16) float autoExposure;
+		// camera frustum planes, read by the GPU culling pass
+		alignas(16) glm::vec4 frustumPlanes[6]{};
+		// clustered lighting: x near, y far, zw framebuffer size
+		alignas(16) glm::vec4 clusterParams{0.1f, 100.f, 1.f, 1.f};
 
-		alignas(16)  glm::vec3 _pad0{0.f};
+		// packed like the std140 block: four scalars in one 16 byte slot
+		alignas(16) int numLights{0};
+		float autoExposure{1.f};
+		float _pad0{0.f};
+		float _pad1{0.f};
 	};
+	static_assert(sizeof(GlobalUbo) % 16 == 0, "GlobalUbo size must match shader");
 
 	struct FrameInfo {
 		int frameIndex;
@@ -74,7 +80,12 @@ namespace enginev {
 		VkCommandBuffer commandBuffer;
 		Camera& camera;
 		VkDescriptorSet globalDescriptorSet;
-		SimObject::Map &simObjects;
+		SceneStore &scene;
+		SceneBvh &bvh;
 		Frustum frustum;
+		Frustum shadowFrustum;
+		// camera being recorded when several are rendered in one frame;
+		// systems with per-camera output keep one copy per view
+		uint32_t viewIndex{ 0 };
 	};
 }
\ No newline at end of file
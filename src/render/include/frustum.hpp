@@ -22,6 +22,16 @@ inline Frustum extractFrustum(const glm::mat4& VP)
     return f;
 }
 
+// Frustum for shadow casters of a directional light. The near plane is
+// replaced by one that accepts everything, so objects between the light
+// and the shadow volume (which can still throw shadows into it) pass.
+inline Frustum extractShadowCasterFrustum(const glm::mat4& lightViewProj)
+{
+    Frustum f = extractFrustum(lightViewProj);
+    f.planes[4] = glm::vec4(0.f, 0.f, 0.f, 1.f);
+    return f;
+}
+
 inline bool isVisible(const Frustum& f, glm::vec3 center, float radius)
 {
     for (int i = 0; i < 6; i++) {
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "frustum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace enginev {
+
+    // Tests count bounding spheres, given as separate x/y/z/radius arrays,
+    // against all six frustum planes and writes indexBase + i of every
+    // visible sphere to outIndices (which must have room for count entries).
+    // Returns the number of visible spheres. Uses AVX2 (8 spheres per step)
+    // or SSE (4 per step) when available and falls back to scalar code.
+    size_t cullSpheres(
+        const Frustum& frustum,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        size_t count,
+        uint32_t* outIndices,
+        uint32_t indexBase = 0);
+
+    // Reference implementation with the same contract as cullSpheres.
+    size_t cullSpheresScalar(
+        const Frustum& frustum,
+        const float* xs, const float* ys, const float* zs, const float* radii,
+        size_t count,
+        uint32_t* outIndices,
+        uint32_t indexBase = 0);
+
+    // Name of the kernel cullSpheres dispatches to ("avx2", "sse", "scalar").
+    const char* cullKernelName();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "device.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace enginev {
+
+    // Named GPU timestamp scopes inside a frame's command buffer. Every
+    // frame in flight has its own query pool; beginFrame() reads the pool
+    // of the frame that used the same slot before, which has completed
+    // once Renderer::beginFrame() returned, so results never wait on the
+    // GPU. They arrive MAX_FRAMES_IN_FLIGHT frames late.
+    //
+    // Both timestamps of a scope are written at BOTTOM_OF_PIPE: a scope
+    // starts once the work recorded before it has finished, so consecutive
+    // scopes do not overlap and add up to the frame. The "frame" scope
+    // (FRAME_SCOPE) spans the whole command buffer, from beginFrame() to
+    // endFrame().
+    class GpuProfiler {
+    public:
+        // The query pools hold a timestamp pair for every registered scope
+        // recorded twice per frame, and at least this many pairs; scopes
+        // past that are dropped (with a warning, once).
+        static constexpr uint32_t MIN_SCOPES_PER_FRAME = 64;
+        // frames the rolling averages are taken over
+        static constexpr uint32_t AVERAGE_WINDOW = 120;
+        // registered by the constructor
+        static constexpr uint32_t FRAME_SCOPE = 0;
+
+        struct ScopeTiming {
+            std::string name;
+            double averageMs = 0.0;  // over the last AVERAGE_WINDOW frames that recorded it
+            double lastMs = 0.0;
+        };
+
+        // Scope times of one completed frame; a scope recorded several
+        // times in the frame is summed. frameNumber as passed to
+        // beginFrame(), 0 = nothing collected yet.
+        struct FrameTimings {
+            uint64_t frameNumber = 0;
+            std::vector<std::pair<uint32_t, double>> scopes;  // scope id, ms
+        };
+
+        explicit GpuProfiler(Device& device);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        // Creates the query pools. Until then, and if this returns false
+        // because the graphics queue has no timestamps, every call below
+        // is a no-op.
+        bool enable();
+        bool isEnabled() const { return !slots.empty(); }
+
+        // Returns the id passed to beginScope()/endScope(); registering a
+        // name twice returns the same id.
+        uint32_t registerScope(const std::string& name);
+        const std::string& scopeName(uint32_t scope) const { return scopes[scope].name; }
+
+        // Right after Renderer::beginFrame(), outside any render pass.
+        void beginFrame(VkCommandBuffer commandBuffer, int frameIndex, uint64_t frameNumber);
+        // Right before Renderer::endFrame().
+        void endFrame(VkCommandBuffer commandBuffer);
+        // Scopes may nest but not interleave with themselves.
+        void beginScope(VkCommandBuffer commandBuffer, uint32_t scope);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+        // Rolling averages of every scope that has been recorded, in
+        // registration order.
+        std::vector<ScopeTiming> getTimings() const;
+        const FrameTimings& getLastFrame() const { return lastFrame; }
+
+    private:
+        struct Record {
+            uint32_t scope;
+            uint32_t beginQuery;
+            uint32_t endQuery;  // NO_QUERY while open
+        };
+
+        struct FrameSlot {
+            VkQueryPool pool{ VK_NULL_HANDLE };
+            uint64_t frameNumber{ 0 };  // 0 = no queries written
+            uint32_t queryCapacity{ 0 };
+            uint32_t queryCount{ 0 };
+            // end queries owed to the open scopes, kept free by beginScope()
+            uint32_t reservedQueries{ 0 };
+            std::vector<Record> records;
+        };
+
+        struct Scope {
+            std::string name;
+            std::vector<double> samples;  // ring of AVERAGE_WINDOW
+            size_t next{ 0 };
+            size_t count{ 0 };
+            double sum{ 0.0 };
+            double last{ 0.0 };
+        };
+
+        static constexpr uint32_t NO_QUERY = ~0u;
+
+        void createPool(FrameSlot& slot, uint32_t queryCapacity);
+        void collect(FrameSlot& slot);
+        void addSample(Scope& scope, double milliseconds);
+
+        Device& device;
+        std::vector<FrameSlot> slots;
+        FrameSlot* current{ nullptr };
+        uint64_t timestampMask{ 0 };
+
+        std::vector<Scope> scopes;
+        FrameTimings lastFrame{};
+        bool droppedScopeReported{ false };
+        std::vector<uint64_t> results;
+        std::vector<double> frameScopeMs;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+#include "scene_store.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace enginev {
+
+    // Groups a visible set by model and writes the instance data of each
+    // group contiguously into a per-frame, host-visible vertex buffer, so
+    // every model can be drawn with a single instanced draw call.
+    class InstanceBatcher {
+    public:
+        struct Batch {
+            uint32_t modelHandle;
+            uint32_t firstInstance;
+            uint32_t instanceCount;
+        };
+
+        explicit InstanceBatcher(Device& device);
+
+        InstanceBatcher(const InstanceBatcher&) = delete;
+        InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+        const std::vector<Batch>& build(
+            int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& slots);
+
+        VkBuffer getBuffer(int frameIndex) const { return instanceBuffers[frameIndex]->getBuffer(); }
+
+    private:
+        void ensureCapacity(int frameIndex, size_t instanceCount);
+
+        Device& device;
+
+        std::vector<std::unique_ptr<Buffer>> instanceBuffers;
+        std::vector<Batch> batches;
+        std::vector<uint32_t> counts;
+        std::vector<uint32_t> offsets;
+    };
+}
@@ -71,7 +71,7 @@ private:
     VkExtent2D flareExtent_{};
 
     VkImage        flareImage_{VK_NULL_HANDLE};
-    VkDeviceMemory flareImageMemory_{VK_NULL_HANDLE};
+    DeviceAllocation flareImageAllocation_;
     VkImageView    flareImageView_{VK_NULL_HANDLE};
     VkSampler      flareSampler_{VK_NULL_HANDLE};
     VkFormat       flareFormat_{VK_FORMAT_R16G16B16A16_SFLOAT};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+#include "scene_store.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace enginev {
+
+    // Point lights of a SceneStore mirrored into a host-visible storage
+    // buffer per frame in flight (global set, binding 3). The buffers grow
+    // with the light count; after the first full upload only the lights
+    // reported by SceneStore::flushLights() are rewritten.
+    class LightBuffer {
+    public:
+        // Irradiance below which a light is treated as having no influence.
+        // Together with the intensity it gives the light radius stored in
+        // PointLight::position.w (used by clustered lighting).
+        static constexpr float LIGHT_CUTOFF = 0.005f;
+
+        static float influenceRadius(const glm::vec4& colorIntensity);
+
+        explicit LightBuffer(Device& device);
+
+        LightBuffer(const LightBuffer&) = delete;
+        LightBuffer& operator=(const LightBuffer&) = delete;
+
+        // changedSlots: light slots as returned by SceneStore::flushLights().
+        // Returns true when the buffer of frameIndex was reallocated and the
+        // descriptor pointing at it has to be rewritten.
+        bool update(int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& changedSlots);
+
+        VkDescriptorBufferInfo descriptorInfo(int frameIndex) const;
+
+    private:
+        struct FrameResources {
+            std::unique_ptr<Buffer> buffer;
+            std::vector<uint32_t> pendingSlots;
+            bool fullUpload = true;
+        };
+
+        bool ensureCapacity(FrameResources& frame, size_t lightCount);
+        void writeLight(FrameResources& frame, const SceneStore& scene, uint32_t slot);
+
+        Device& device;
+
+        std::vector<FrameResources> frames;
+        uint64_t uploadedVersion = 0;
+        bool uploaded = false;
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "model.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace enginev {
+
+    // Read-only memory mapping of a whole file.
+    class MappedFile {
+    public:
+        // isOpen() is false if the file is missing, empty or cannot be mapped.
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return mapping != nullptr; }
+        const uint8_t* data() const { return static_cast<const uint8_t*>(mapping); }
+        size_t size() const { return length; }
+
+    private:
+        void* mapping{ nullptr };
+        size_t length{ 0 };
+#ifdef _WIN32
+        void* fileHandle{ nullptr };
+        void* mappingHandle{ nullptr };
+#endif
+    };
+
+    // Binary copy of a model's deduplicated geometry, stored as
+    // <model>.meshcache next to the model:
+    //
+    //   Header                         magic, version, Vertex size, FNV-1a
+    //                                  hash and size of the source file,
+    //                                  counts and bounds
+    //   Vertex[vertexCount]            Model::Vertex as laid out in memory
+    //   uint32_t[indexCount]
+    //
+    // A cache is only used while its source hash, version and vertex
+    // layout match, so editing the model or Vertex invalidates it.
+    class MeshCache {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        static std::string cachePath(const std::string& modelPath) { return modelPath + ".meshcache"; }
+
+        // Maps the cache of modelPath. Returns null if there is none or it
+        // is stale; the caller then parses the model and calls write().
+        static std::unique_ptr<MeshCache> open(const std::string& modelPath);
+        // Returns false if the cache cannot be written (e.g. a read-only
+        // model directory); the model still loads, just without a cache.
+        static bool write(const std::string& modelPath, const Model::Builder& builder);
+
+        // Points into the mapping, valid while this MeshCache lives.
+        const Model::MeshData& getMeshData() const { return mesh; }
+
+    private:
+        explicit MeshCache(const std::string& path) : file{ path } {}
+
+        MappedFile file;
+        Model::MeshData mesh{};
+    };
+
+    // CPU side of Model::createModelFromFile: the geometry of one model
+    // file, mapped from its up-to-date cache or parsed from the OBJ (which
+    // writes the cache). Touches no Vulkan state, so models can be loaded
+    // on worker threads and uploaded afterwards.
+    class LoadedMesh {
+    public:
+        static std::unique_ptr<LoadedMesh> load(const std::string& modelPath);
+
+        LoadedMesh(const LoadedMesh&) = delete;
+        LoadedMesh& operator=(const LoadedMesh&) = delete;
+
+        const Model::MeshData& getMeshData() const { return mesh; }
+        bool isFromCache() const { return cache != nullptr; }
+
+    private:
+        LoadedMesh() = default;
+
+        std::unique_ptr<MeshCache> cache;
+        Model::Builder builder;  // empty when mapped from the cache
+        Model::MeshData mesh{};
+    };
+}
@@ -2,6 +2,7 @@
 
 #include "device.hpp"
 #include "buffer.hpp"
+#include "upload_batcher.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -29,6 +30,18 @@ namespace enginev {
 			}
 		};
 
+		// Per-instance vertex data (binding 1) for the instanced pipelines.
+		struct InstanceData {
+			glm::mat4 modelMatrix{ 1.f };
+			glm::mat4 normalMatrix{ 1.f };
+
+			static constexpr uint32_t BINDING = 1;
+			static constexpr uint32_t FIRST_LOCATION = 4;
+
+			static VkVertexInputBindingDescription getBindingDescription();
+			static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+		};
+
 		struct Builder {
 			std::vector<Vertex> vertices{};
 			std::vector<uint32_t> indices{};
@@ -40,24 +53,50 @@ namespace enginev {
 			void loadModel(const std::string& filepath);
 		};
 
-		Model(Device& device, const Model::Builder& builder, float radius);
+		// Geometry to upload, pointing into a Builder or straight into a
+		// mapped .meshcache file (see MeshCache).
+		struct MeshData {
+			const Vertex* vertices = nullptr;
+			uint32_t vertexCount = 0;
+			const uint32_t* indices = nullptr;
+			uint32_t indexCount = 0;
+
+			glm::vec3 bboxMin{};
+			glm::vec3 bboxMax{};
+			float boundingRadius{};
+		};
+
+		// Both queue the copies on uploader instead of submitting them: the
+		// model is not drawable before uploader.flush().
+		Model(Device& device, const Model::Builder& builder, float radius, UploadBatcher& uploader);
+		Model(Device& device, const MeshData& mesh, UploadBatcher& uploader);
 		~Model();
 
 		Model(const Model&) = delete;
 		Model& operator=(const Model&) = delete;
 
+		// Uploads the geometry of filepath's .meshcache if it is up to
+		// date; otherwise parses the OBJ and writes the cache beside it.
+		// Drawable after uploader.flush().
 		static std::unique_ptr<Model> createModelFromFile(
-			Device& device, const std::string& filepath);
+			Device& device, const std::string& filepath, UploadBatcher& uploader);
 
 		float boundingRadius = 1.0f;
+		glm::vec3 boundingCenter{0.f};
 
 		void bind(VkCommandBuffer commandBuffer);
 		void draw(VkCommandBuffer commandBuffer);
-		static std::shared_ptr<Model> createSkyboxCube(Device& device);
+		void drawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance);
+
+		// Indirect command template with instanceCount = 0. For models without
+		// an index buffer the first four fields form a VkDrawIndirectCommand.
+		VkDrawIndexedIndirectCommand getIndirectCommand() const;
+		void drawIndirect(VkCommandBuffer commandBuffer, VkBuffer commandBufferHandle, VkDeviceSize offset);
+		static std::shared_ptr<Model> createSkyboxCube(Device& device, UploadBatcher& uploader);
 
 	private:
-		void createVertexBuffers(const std::vector<Vertex>& vertices);
-		void createIndexBuffers(const std::vector<uint32_t>& indices);
+		void createVertexBuffers(const Vertex* vertices, uint32_t count, UploadBatcher& uploader);
+		void createIndexBuffers(const uint32_t* indices, uint32_t count, UploadBatcher& uploader);
 
 		Device& device;
 
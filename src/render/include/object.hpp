@@ -5,7 +5,6 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <memory>
-#include <unordered_map>
 
 namespace enginev {
 
@@ -14,8 +13,17 @@ namespace enginev {
         glm::vec3 scale{ 1.f, 1.f, 1.f };
         glm::vec3 rotation{};
 
-        glm::mat4 mat4();
-        glm::mat3 normalMatrix();
+        glm::mat4 mat4() const;
+        glm::mat3 normalMatrix() const;
+
+        // Cached mat4()/normalMatrix(), valid while dirty == false.
+        // Objects owned by SceneStore are refreshed once per frame in
+        // SceneStore::flushTransforms(), so passes only read these.
+        glm::mat4 worldMatrix{ 1.f };
+        glm::mat4 worldNormalMatrix{ 1.f };
+        bool dirty = true;
+
+        void updateMatrices();
     };
 
     struct PointLightComponent {
@@ -25,7 +33,6 @@ namespace enginev {
     class SimObject {
     public:
         using id_t = unsigned int;
-        using Map = std::unordered_map<id_t, SimObject>;
 
         static SimObject createSimObject() {
             static id_t currentId = 0;
@@ -45,6 +52,8 @@ namespace enginev {
         std::shared_ptr<Model> model{};
         glm::vec3 color{};
         TransformComponent transform{};
+        // class id published in semantic label mode, 0 = unlabeled
+        uint32_t semanticClass = 0;
 
         std::unique_ptr<PointLightComponent> pointLight = nullptr;
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "device.hpp"
+#include "swap_chain.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace enginev {
+
+    // Stand-in for the swap chain in headless mode. Owns one color + depth
+    // framebuffer per frame in flight, rendered with a render pass that is
+    // laid out like the swap chain one (color ends in TRANSFER_SRC layout
+    // for the readback copy). Nothing is presented, so a frame only waits
+    // for the GPU to finish the frame that used the same image before.
+    // Cameras that are not shown in the window render into one as well;
+    // they index the images with the renderer's frame index and never call
+    // acquireNextImage()/submitCommandBuffers().
+    class OffscreenTarget {
+    public:
+        // Same format the swap chain prefers, so captured frames are
+        // byte-identical to windowed mode (published as bgra8).
+        static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_B8G8R8A8_SRGB;
+
+        OffscreenTarget(Device& deviceRef, VkExtent2D extent);
+        ~OffscreenTarget();
+
+        OffscreenTarget(const OffscreenTarget&) = delete;
+        OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+        VkFramebuffer getFrameBuffer(int index) { return framebuffers[index]; }
+        VkRenderPass getRenderPass() { return renderPass; }
+        VkImage getImage(uint32_t index) const { return colorImages.at(index); }
+        VkImageView getImageView(uint32_t index) const { return colorImageViews.at(index); }
+        VkExtent2D getExtent() { return extent; }
+
+        float extentAspectRatio() {
+            return static_cast<float>(extent.width) / static_cast<float>(extent.height);
+        }
+
+        // Begins the render pass on image index and sets viewport/scissor.
+        void beginRenderPass(VkCommandBuffer cmd, uint32_t index);
+        // Copies image index (TRANSFER_SRC after the render pass) into
+        // dstBuffer and makes the copy visible to host reads.
+        void copyImageToBuffer(VkCommandBuffer cmd, uint32_t index, VkBuffer dstBuffer);
+
+        // Waits until the image of the next frame is no longer in use.
+        VkResult acquireNextImage(uint32_t* imageIndex);
+        VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+
+    private:
+        void createColorResources();
+        void createDepthResources();
+        void createRenderPass();
+        void createFramebuffers();
+        void createSyncObjects();
+
+        Device& device;
+        VkExtent2D extent;
+        VkFormat depthFormat;
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::vector<VkFramebuffer> framebuffers;
+
+        std::vector<VkImage> colorImages;
+        std::vector<VkDeviceMemory> colorImageMemorys;
+        std::vector<VkImageView> colorImageViews;
+        std::vector<VkImage> depthImages;
+        std::vector<VkDeviceMemory> depthImageMemorys;
+        std::vector<VkImageView> depthImageViews;
+
+        std::vector<VkFence> inFlightFences;
+        size_t currentFrame = 0;
+    };
+}
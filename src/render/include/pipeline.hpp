@@ -19,6 +19,10 @@ namespace enginev {
 		VkPipelineRasterizationStateCreateInfo rasterizationInfo;
 		VkPipelineMultisampleStateCreateInfo multisampleInfo;
 		VkPipelineColorBlendAttachmentState colorBlendAttachment;
+		// second color attachment of render passes with a label target
+		// (see enableLabelAttachment)
+		bool labelAttachment = false;
+		VkPipelineColorBlendAttachmentState labelBlendAttachment{};
 		VkPipelineColorBlendStateCreateInfo colorBlendInfo;
 		VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
 		std::vector<VkDynamicState> dynamicStateEnables;
@@ -44,16 +48,21 @@ namespace enginev {
 
 		static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 		static void enablleAlphaBlending(PipelineConfigInfo& configInfo);
-	private:
+		static void enableInstancing(PipelineConfigInfo& configInfo);
+		// For render passes that also have an R32_UINT label attachment;
+		// pipelines that do not write labels leave it untouched.
+		static void enableLabelAttachment(PipelineConfigInfo& configInfo, bool writeLabel);
+
+		// Shared with the compute systems, which build their own pipelines.
 		static std::vector<char> readFile(const std::string& filename);
+		static VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+	private:
 
 		void createGraphicsPipeline(
 			const std::string& vertFilepath,
 			const std::string& fragFilepath,
 			const PipelineConfigInfo& configInfo);
 
-		void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
-
 		Device& device;
 		VkPipeline graphicsPipeline;
 		VkShaderModule vertShaderModule;
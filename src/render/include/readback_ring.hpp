@@ -0,0 +1,85 @@
+#pragma once
+
+#include "device.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace enginev {
+
+    // Ring of host-visible readback buffers. The render thread acquires a
+    // free slot, records a copy into it and submits it; submit() queues an
+    // empty batch with the slot's fence, which signals once all previously
+    // submitted work (including the copy) has completed. A worker thread
+    // waits for the fences in submission order and hands each finished
+    // frame to the consumer, then returns the slot to the ring. The render
+    // thread never waits: when every slot is still in flight, acquire()
+    // returns nullptr and the frame is simply not captured.
+    class ReadbackRing {
+    public:
+        struct Frame {
+            const void* data;
+            size_t size;
+            uint32_t width;
+            uint32_t height;
+            int64_t captureTimeNs;  // system clock, taken at submit()
+        };
+
+        struct Slot {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            void* mapped = nullptr;
+            VkDeviceSize capacity = 0;
+            VkFence fence = VK_NULL_HANDLE;
+
+            VkDeviceSize size = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            int64_t captureTimeNs = 0;
+            bool free = true;
+        };
+
+        using Consumer = std::function<void(const Frame&)>;
+
+        ReadbackRing(Device& device, size_t slotCount, Consumer consumer);
+        ~ReadbackRing();
+
+        ReadbackRing(const ReadbackRing&) = delete;
+        ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+        // Returns a free slot whose buffer holds at least size bytes, or
+        // nullptr when all slots are in flight.
+        Slot* acquire(VkDeviceSize size, uint32_t width, uint32_t height);
+
+        // Call after the command buffer containing the copy into slot has
+        // been submitted to the graphics queue.
+        void submit(Slot* slot);
+
+        uint64_t getDroppedFrames() const { return droppedFrames; }
+
+    private:
+        void ensureCapacity(Slot& slot, VkDeviceSize size);
+        void destroyBuffer(Slot& slot);
+        void workerLoop();
+
+        Device& device;
+        Consumer consumer;
+
+        std::vector<Slot> slots;
+        uint64_t droppedFrames = 0;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Slot*> pending;
+        bool stopping = false;
+
+        std::thread worker;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "device.hpp"
+#include "offscreen_target.hpp"
 #include "swap_chain.hpp"
 #include "window.hpp"
 
@@ -13,13 +14,21 @@ namespace enginev {
     class Renderer {
     public:
         Renderer(Window& window, Device& device);
+        // Headless: frames go to an OffscreenTarget of the given extent
+        // instead of a swap chain and are never presented.
+        Renderer(Device& device, VkExtent2D extent);
         ~Renderer();
 
         Renderer(const Renderer&) = delete;
         Renderer& operator=(const Renderer&) = delete;
 
-        VkRenderPass getSwapChainRenderPass() const { return swapChain->getRenderPass(); }
-        float getAspectRatio() const { return swapChain->extentAspectRatio(); }
+        VkRenderPass getSwapChainRenderPass() const {
+            return offscreen ? offscreen->getRenderPass() : swapChain->getRenderPass();
+        }
+        float getAspectRatio() const {
+            return offscreen ? offscreen->extentAspectRatio() : swapChain->extentAspectRatio();
+        }
+        bool isHeadless() const { return offscreen != nullptr; }
         bool isFrameInProgress() const { return isFrameStarted; }
 
         VkCommandBuffer getCurrentCommandBuffer() const {
@@ -31,26 +40,36 @@ namespace enginev {
             assert(isFrameStarted && "Cannot get frame index when frame not in progress");
             return currentFrameIndex;
         }
+        // Number of the frame being recorded (1 for the first frame).
+        uint64_t getFrameNumber() const { return frameNumber; }
 
         VkCommandBuffer beginFrame();
         void endFrame();
         void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // Both leave the swap chain image in PRESENT_SRC layout; the render
+        // pass hands it over in TRANSFER_SRC layout for the readback copy.
+        // Offscreen images stay in TRANSFER_SRC, the transition is a no-op.
         void copySwapImageToBuffer(VkCommandBuffer cmd, VkBuffer dstBuffer);
-        VkExtent2D getSwapChainExtent() const {return swapChain->getSwapChainExtent();}
+        void transitionSwapImageToPresent(VkCommandBuffer cmd);
+        VkExtent2D getSwapChainExtent() const {
+            return offscreen ? offscreen->getExtent() : swapChain->getSwapChainExtent();
+        }
 
     private:
         void createCommandBuffers();
         void freeCommandBuffers();
         void recreateSwapChain();
 
-        Window& window;
+        Window* window;
         Device& device;
         std::unique_ptr<SwapChain> swapChain;
+        std::unique_ptr<OffscreenTarget> offscreen;
         std::vector<VkCommandBuffer> commandBuffers;
 
         uint32_t currentImageIndex;
         int currentFrameIndex{ 0 };
         bool isFrameStarted{ false };
+        uint64_t frameNumber{ 0 };
     };
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "scene_store.hpp"
+#include "frustum.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace enginev {
+
+    // Bounding volume hierarchy over the object bounds of a SceneStore.
+    // Rebuilt when objects are added or removed, refit bottom-up for objects
+    // whose transforms changed. Leaves and subtrees own contiguous ranges of
+    // the item array, so a node fully inside the frustum is emitted without
+    // testing its children.
+    class SceneBvh {
+    public:
+        static constexpr uint32_t MAX_LEAF_ITEMS = 8;
+
+        explicit SceneBvh(const SceneStore& store);
+
+        SceneBvh(const SceneBvh&) = delete;
+        SceneBvh& operator=(const SceneBvh&) = delete;
+
+        // changedSlots: object slots whose bounds changed (as returned by
+        // SceneStore::flushTransforms()).
+        void update(const std::vector<uint32_t>& changedSlots);
+        void rebuild();
+
+        // Appends the object slots that intersect the frustum to outSlots.
+        void query(const Frustum& frustum, std::vector<uint32_t>& outSlots) const;
+
+        size_t nodeCount() const { return nodes.size(); }
+        size_t itemCount() const { return items.size(); }
+
+    private:
+        static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+        struct Node {
+            glm::vec3 boundsMin{};
+            uint32_t firstItem = 0;
+            glm::vec3 boundsMax{};
+            uint32_t itemCount = 0;
+            uint32_t left = INVALID_NODE;
+            uint32_t right = INVALID_NODE;
+            uint32_t parent = INVALID_NODE;
+            uint32_t refitStamp = 0;
+
+            bool isLeaf() const { return left == INVALID_NODE; }
+        };
+
+        uint32_t buildNode(uint32_t first, uint32_t count, uint32_t parent);
+        void computeLeafBounds(Node& node) const;
+        void packItem(uint32_t item);
+        void refit(const std::vector<uint32_t>& changedSlots);
+
+        const SceneStore& store;
+        uint64_t builtVersion = 0;
+        bool built = false;
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> items;       // object slots, grouped by leaf
+        std::vector<uint32_t> itemOfSlot;  // object slot -> index into items
+        std::vector<uint32_t> leafOfSlot;  // object slot -> leaf node
+
+        // bounding spheres of items, packed for the SIMD culling kernel
+        std::vector<float> packedX;
+        std::vector<float> packedY;
+        std::vector<float> packedZ;
+        std::vector<float> packedR;
+
+        std::vector<uint32_t> refitQueue;
+        uint32_t refitCounter = 0;
+    };
+}
@@ -10,7 +10,11 @@ namespace enginev {
 
 class ScenePass {
 public:
-    ScenePass(Device& device);
+    // Per-pixel object labels written by the scene pipelines as a second
+    // color attachment, copied out for publishing.
+    static constexpr VkFormat LABEL_FORMAT = VK_FORMAT_R32_UINT;
+
+    ScenePass(Device& device, bool labelAttachment = false);
     ~ScenePass();
 
     ScenePass(const ScenePass&) = delete;
@@ -37,14 +41,21 @@ public:
     VkImageView getDepthView() const { return sceneDepthView; }
     VkSampler getDepthSampler() const { return sceneDepthSampler; }
 
+    bool hasLabelAttachment() const { return labelAttachment; }
+    // Copies the label image (TRANSFER_SRC after end()) into dstBuffer and
+    // makes the copy visible to host reads. Record after end().
+    void copyLabelToBuffer(VkCommandBuffer cmd, VkBuffer dstBuffer);
+
 private:
     void createSceneColorTarget(VkExtent2D extent);
     void createSceneDepthTarget(VkExtent2D extent);
+    void createSceneLabelTarget(VkExtent2D extent);
     void createSceneRenderPass(VkFormat colorFormat, VkFormat depthFormat);
     void createSceneFramebuffer();
 
 private:
     Device& device;
+    bool labelAttachment;
 
     VkExtent2D sceneExtent{0, 0};
 
@@ -52,15 +63,19 @@ private:
     VkFormat sceneDepthFormat = VK_FORMAT_UNDEFINED;
 
     VkImage        sceneColorImage   = VK_NULL_HANDLE;
-    VkDeviceMemory sceneColorMemory  = VK_NULL_HANDLE;
+    DeviceAllocation sceneColorAllocation;
     VkImageView    sceneColorView    = VK_NULL_HANDLE;
     VkSampler      sceneColorSampler = VK_NULL_HANDLE;
 
     VkImage        sceneDepthImage   = VK_NULL_HANDLE;
-    VkDeviceMemory sceneDepthMemory  = VK_NULL_HANDLE;
+    DeviceAllocation sceneDepthAllocation;
     VkImageView    sceneDepthView    = VK_NULL_HANDLE;
     VkSampler      sceneDepthSampler = VK_NULL_HANDLE;
 
+    VkImage        sceneLabelImage   = VK_NULL_HANDLE;
+    DeviceAllocation sceneLabelAllocation;
+    VkImageView    sceneLabelView    = VK_NULL_HANDLE;
+
     VkRenderPass   sceneRenderPass   = VK_NULL_HANDLE;
     VkFramebuffer  sceneFramebuffer  = VK_NULL_HANDLE;
 };
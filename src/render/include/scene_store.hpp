@@ -0,0 +1,126 @@
+#pragma once
+
+#include "object.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace enginev {
+
+    // Dense, structure-of-arrays storage for everything the render systems
+    // iterate every frame. Objects and point lights live in separate pools;
+    // each pool keeps its arrays tightly packed (swap-remove) and maps the
+    // stable SimObject id to the current slot.
+    class SceneStore {
+    public:
+        using id_t = SimObject::id_t;
+
+        static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+        static constexpr uint32_t NO_MODEL = UINT32_MAX;
+
+        // What objectLabel() returns: the object id + 1 (so that 0 stays
+        // the background) or the object's semantic class.
+        enum class LabelMode { Instance, Semantic };
+
+        SceneStore() = default;
+
+        SceneStore(const SceneStore&) = delete;
+        SceneStore& operator=(const SceneStore&) = delete;
+
+        // Takes over the components of obj. An object with a model goes to the
+        // object pool, an object with a point light goes to the light pool.
+        id_t add(SimObject&& obj);
+        void remove(id_t id);
+        void clear();
+        void reserve(size_t objectCount, size_t lightCount);
+
+        bool contains(id_t id) const;
+        uint32_t objectSlot(id_t id) const;
+        uint32_t lightSlot(id_t id) const;
+
+        size_t objectCount() const { return objectIds.size(); }
+        size_t lightCount() const { return lightIds.size(); }
+        size_t modelCount() const { return models.size(); }
+
+        // Bumped on add/remove/clear, i.e. whenever slots may have moved.
+        uint64_t getStructureVersion() const { return structureVersion; }
+
+        // Only records the change; matrices and bounds are refreshed by
+        // flushTransforms().
+        void setTransform(id_t id, const TransformComponent& transform);
+        void setLightPosition(id_t id, const glm::vec3& position);
+        void setLightColor(id_t id, const glm::vec3& color, float intensity);
+
+        // Recomputes cached matrices and bounds of every object whose
+        // transform changed since the last call. Returns the slots that were
+        // updated (valid until the next call). Call once per frame before
+        // any pass reads the store.
+        const std::vector<uint32_t>& flushTransforms();
+        size_t pendingTransformCount() const { return dirtyIds.size(); }
+
+        // Returns the light slots whose position or color changed since the
+        // last call (valid until the next call).
+        const std::vector<uint32_t>& flushLights();
+
+        void setLabelMode(LabelMode mode) { labelMode = mode; }
+        // Value written to the label attachment for the object in slot.
+        // Kept below 2^24 so it survives the trip through a float.
+        uint32_t objectLabel(uint32_t slot) const;
+
+        uint32_t getModelHandle(const std::shared_ptr<Model>& model);
+        Model* getModel(uint32_t handle) const { return models[handle].get(); }
+
+        // object pool, indexed by slot
+        const std::vector<id_t>& getObjectIds() const { return objectIds; }
+        const std::vector<TransformComponent>& getTransforms() const { return transforms; }
+        const std::vector<glm::vec3>& getColors() const { return colors; }
+        const std::vector<uint32_t>& getModelHandles() const { return modelHandles; }
+        const std::vector<uint32_t>& getSemanticClasses() const { return semanticClasses; }
+        // xyz - world space bounding sphere center, w - radius
+        const std::vector<glm::vec4>& getBounds() const { return bounds; }
+
+        // light pool, indexed by slot
+        const std::vector<id_t>& getLightIds() const { return lightIds; }
+        // xyz - world position, w - billboard radius
+        const std::vector<glm::vec4>& getLightPositions() const { return lightPositions; }
+        // rgb - color, a - intensity
+        const std::vector<glm::vec4>& getLightColors() const { return lightColors; }
+
+    private:
+        void updateBounds(uint32_t slot);
+        void markLightDirty(uint32_t slot);
+
+        static void setSlot(std::vector<uint32_t>& slots, id_t id, uint32_t slot);
+        static uint32_t findSlot(const std::vector<uint32_t>& slots, id_t id);
+
+        uint64_t structureVersion = 0;
+        LabelMode labelMode = LabelMode::Instance;
+
+        std::vector<std::shared_ptr<Model>> models;
+        std::unordered_map<const Model*, uint32_t> modelHandleLookup;
+
+        std::vector<uint32_t> objectSlots;
+        std::vector<id_t> objectIds;
+        std::vector<TransformComponent> transforms;
+        std::vector<glm::vec3> colors;
+        std::vector<uint32_t> modelHandles;
+        std::vector<uint32_t> semanticClasses;
+        std::vector<glm::vec4> bounds;
+
+        std::vector<id_t> dirtyIds;
+        std::vector<uint32_t> flushedSlots;
+
+        std::vector<uint32_t> lightSlots;
+        std::vector<id_t> lightIds;
+        std::vector<glm::vec4> lightPositions;
+        std::vector<glm::vec4> lightColors;
+        std::vector<uint8_t> lightDirty;
+
+        std::vector<id_t> dirtyLightIds;
+        std::vector<uint32_t> flushedLightSlots;
+    };
+}
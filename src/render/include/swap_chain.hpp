@@ -11,6 +11,10 @@
 namespace enginev {
     class SwapChain {
     public:
+        // Per-frame resources are indexed by the renderer's frame index. Once
+        // beginFrame() returns, the GPU has finished the previous frame with
+        // the same index, so its buffers and descriptor sets can be rewritten
+        // or replaced without further synchronization.
         static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
         SwapChain(Device& deviceRef, VkExtent2D windowExtent);
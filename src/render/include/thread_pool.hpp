@@ -0,0 +1,54 @@
+#pragma once
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace enginev {
+
+    // Fixed set of worker threads running submitted jobs in FIFO order.
+    // The destructor finishes the queued jobs before joining.
+    class ThreadPool {
+    public:
+        // threadCount 0 picks one thread per hardware thread; threadName
+        // labels the workers in CpuTracer traces
+        explicit ThreadPool(size_t threadCount = 0, const char* threadName = "worker");
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadCount() const { return workers.size(); }
+
+        // An exception thrown by job is rethrown by the future's get().
+        template <typename F>
+        auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            // std::function needs a copyable callable, packaged_task is not
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+            std::future<Result> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.emplace_back([task] { (*task)(); });
+            }
+            cv.notify_one();
+            return result;
+        }
+
+    private:
+        void workerLoop(const char* threadName);
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> jobs;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool stopping = false;
+    };
+}
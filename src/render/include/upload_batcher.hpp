@@ -0,0 +1,144 @@
+#pragma once
+
+#include "device.hpp"
+
+// std
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace enginev {
+
+    // Collects host-to-device copies and submits them in batches on the
+    // device's transfer queue. The data is copied into a persistently
+    // mapped staging ring right away; submit() records the batch into one
+    // command buffer and returns without waiting, so assets can stream in
+    // while frames keep rendering. An upload that does not fit the ring
+    // gets a staging buffer of its own, freed with its batch.
+    //
+    // With a dedicated transfer family a batch ends in release barriers
+    // and signals a semaphore; poll() hands every finished batch to the
+    // graphics queue (acquire barriers, waiting on that semaphore). On a
+    // GPU without one the copies go to the graphics queue and are ordered
+    // before later work by a barrier instead.
+    //
+    // Destinations of a batch may be used by command buffers submitted to
+    // the graphics queue once getCompletedTicket() reaches its ticket.
+    // Render-thread only, like the rest of the queue submission.
+    class UploadBatcher {
+    public:
+        static constexpr VkDeviceSize DEFAULT_CAPACITY = 16 * 1024 * 1024;
+        static constexpr uint32_t MAX_BATCHES = 4;
+
+        explicit UploadBatcher(Device& device, VkDeviceSize capacity = DEFAULT_CAPACITY);
+        // Waits for the submitted batches; copies never submitted are
+        // dropped, their destinations may already be gone.
+        ~UploadBatcher();
+
+        UploadBatcher(const UploadBatcher&) = delete;
+        UploadBatcher& operator=(const UploadBatcher&) = delete;
+
+        void uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+        // Fills every layer of a color image with tightly packed texels
+        // and leaves it in SHADER_READ_ONLY_OPTIMAL; the previous contents
+        // are discarded.
+        void uploadImage(
+            VkImage image, const void* data, VkDeviceSize size,
+            uint32_t width, uint32_t height, uint32_t layerCount = 1);
+
+        // Submits the pending copies without waiting. Returns the ticket
+        // covering every upload made so far, 0 if there never was one.
+        uint64_t submit();
+        // Non-blocking: hands the batches the transfer queue has finished
+        // to the graphics queue. Returns getCompletedTicket().
+        uint64_t poll();
+        uint64_t getCompletedTicket() const { return completedTicket; }
+        // submit() and wait until every upload so far is usable.
+        void flush();
+
+        bool hasPending() const { return !bufferCopies.empty() || !imageCopies.empty(); }
+        bool usesDedicatedQueue() const { return dedicated; }
+        uint32_t getSubmitCount() const { return submitCount; }
+        VkDeviceSize getUploadedBytes() const { return uploadedBytes; }
+
+    private:
+        struct BufferCopy {
+            VkBuffer src;
+            VkBuffer dst;
+            VkBufferCopy region;
+        };
+
+        struct ImageCopy {
+            VkBuffer src;
+            VkImage dst;
+            VkBufferImageCopy region;
+        };
+
+        struct Overflow {
+            VkBuffer buffer;
+            VkDeviceMemory memory;
+        };
+
+        enum class BatchState { Free, Transferring, Acquiring };
+
+        struct Batch {
+            BatchState state = BatchState::Free;
+            uint64_t ticket = 0;
+            VkDeviceSize ringEnd = 0;
+
+            VkCommandBuffer transferCommands = VK_NULL_HANDLE;
+            VkFence transferFence = VK_NULL_HANDLE;
+
+            // dedicated transfer queue only
+            VkCommandBuffer acquireCommands = VK_NULL_HANDLE;
+            VkFence acquireFence = VK_NULL_HANDLE;
+            VkSemaphore transferDone = VK_NULL_HANDLE;
+            std::vector<VkBufferMemoryBarrier> bufferAcquires;
+            std::vector<VkImageMemoryBarrier> imageAcquires;
+
+            std::vector<Overflow> overflow;
+        };
+
+        // copies data into staging memory, returns the buffer and offset
+        // to copy from
+        VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& srcOffset);
+        bool allocateFromRing(VkDeviceSize size, VkDeviceSize& offset);
+        bool isRingInUse() const { return pendingUsesRing || !transferring.empty(); }
+
+        void recordTransfer(Batch& batch);
+        // Transferring -> Acquiring (or Free); false if the copies are not
+        // done and wait is false
+        bool finishTransfer(Batch& batch, bool wait);
+        Batch& acquireFreeBatch();
+        void releaseOverflow(std::vector<Overflow>& buffers);
+
+        Device& device;
+        const bool dedicated;
+        VkDeviceSize capacity;
+        VkDeviceSize alignment;
+
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;
+        // live staging data is [tail, head), wrapping around the end
+        VkDeviceSize head = 0;
+        VkDeviceSize tail = 0;
+        bool pendingUsesRing = false;
+
+        VkCommandPool transferPool = VK_NULL_HANDLE;
+        std::array<Batch, MAX_BATCHES> batches;
+        // in submission order
+        std::deque<Batch*> transferring;
+        std::deque<Batch*> acquiring;
+
+        std::vector<BufferCopy> bufferCopies;
+        std::vector<ImageCopy> imageCopies;
+        std::vector<Overflow> pendingOverflow;
+
+        uint64_t submittedTicket = 0;
+        uint64_t completedTicket = 0;
+        uint32_t submitCount = 0;
+        VkDeviceSize uploadedBytes = 0;
+    };
+}
@@ -0,0 +1,77 @@
+#include "instance_batcher.hpp"
+#include "swap_chain.hpp"
+
+#include <algorithm>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t MIN_INSTANCE_CAPACITY = 1024;
+    }
+
+    InstanceBatcher::InstanceBatcher(Device& device)
+        : device{ device }, instanceBuffers(SwapChain::MAX_FRAMES_IN_FLIGHT) {
+        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; ++i) {
+            ensureCapacity(i, MIN_INSTANCE_CAPACITY);
+        }
+    }
+
+    void InstanceBatcher::ensureCapacity(int frameIndex, size_t instanceCount) {
+        auto& buffer = instanceBuffers[frameIndex];
+        if (buffer && buffer->getInstanceCount() >= instanceCount) {
+            return;
+        }
+
+        uint32_t capacity = buffer ? buffer->getInstanceCount() : MIN_INSTANCE_CAPACITY;
+        while (capacity < instanceCount) {
+            capacity *= 2;
+        }
+
+        buffer = std::make_unique<Buffer>(
+            device,
+            sizeof(Model::InstanceData),
+            capacity,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        buffer->map();
+    }
+
+    const std::vector<InstanceBatcher::Batch>& InstanceBatcher::build(
+        int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& slots) {
+        batches.clear();
+        if (slots.empty()) {
+            return batches;
+        }
+
+        const auto& modelHandles = scene.getModelHandles();
+        const auto& transforms = scene.getTransforms();
+        const size_t modelCount = scene.modelCount();
+
+        // counting sort of the visible slots by model handle
+        counts.assign(modelCount, 0);
+        for (uint32_t slot : slots) {
+            ++counts[modelHandles[slot]];
+        }
+
+        offsets.resize(modelCount);
+        uint32_t running = 0;
+        for (uint32_t handle = 0; handle < modelCount; ++handle) {
+            offsets[handle] = running;
+            if (counts[handle] > 0) {
+                batches.push_back({ handle, running, counts[handle] });
+                running += counts[handle];
+            }
+        }
+
+        ensureCapacity(frameIndex, slots.size());
+        auto* instances = static_cast<Model::InstanceData*>(instanceBuffers[frameIndex]->getMappedMemory());
+        for (uint32_t slot : slots) {
+            Model::InstanceData& dst = instances[offsets[modelHandles[slot]]++];
+            dst.modelMatrix = transforms[slot].worldMatrix;
+            dst.normalMatrix = transforms[slot].worldNormalMatrix;
+            dst.normalMatrix[3][3] = static_cast<float>(scene.objectLabel(slot));
+        }
+
+        return batches;
+    }
+}
@@ -81,7 +81,7 @@ namespace enginev {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             flareImage_,
-            flareImageMemory_);
+            flareImageAllocation_);
 
         device_.transitionImageLayout(
             flareImage_,
@@ -219,12 +219,7 @@ namespace enginev {
             flareImageView_ = VK_NULL_HANDLE;
         }
         if (flareImage_ != VK_NULL_HANDLE) {
-            vkDestroyImage(device_.device(), flareImage_, nullptr);
-            flareImage_ = VK_NULL_HANDLE;
-        }
-        if (flareImageMemory_ != VK_NULL_HANDLE) {
-            vkFreeMemory(device_.device(), flareImageMemory_, nullptr);
-            flareImageMemory_ = VK_NULL_HANDLE;
+            device_.destroyImage(flareImage_, flareImageAllocation_);
         }
     }
 
@@ -0,0 +1,100 @@
+#include "light_buffer.hpp"
+#include "cpu_tracer.hpp"
+#include "frame_info.hpp"
+#include "swap_chain.hpp"
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t MIN_LIGHT_CAPACITY = 256;
+    }
+
+    float LightBuffer::influenceRadius(const glm::vec4& colorIntensity) {
+        // attenuation is 1 / d^2, so intensity / d^2 == cutoff at d == radius
+        const float peak = colorIntensity.w *
+            glm::max(colorIntensity.r, glm::max(colorIntensity.g, colorIntensity.b));
+        return glm::max(glm::sqrt(glm::max(peak, 0.f) / LIGHT_CUTOFF), 1e-3f);
+    }
+
+    LightBuffer::LightBuffer(Device& device)
+        : device{ device }, frames(SwapChain::MAX_FRAMES_IN_FLIGHT) {
+        for (auto& frame : frames) {
+            ensureCapacity(frame, MIN_LIGHT_CAPACITY);
+        }
+    }
+
+    bool LightBuffer::ensureCapacity(FrameResources& frame, size_t lightCount) {
+        if (frame.buffer && frame.buffer->getInstanceCount() >= lightCount) {
+            return false;
+        }
+
+        uint32_t capacity = frame.buffer ? frame.buffer->getInstanceCount() : MIN_LIGHT_CAPACITY;
+        while (capacity < lightCount) {
+            capacity *= 2;
+        }
+
+        frame.buffer = std::make_unique<Buffer>(
+            device,
+            sizeof(PointLight),
+            capacity,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.buffer->map();
+        frame.fullUpload = true;
+        return true;
+    }
+
+    void LightBuffer::writeLight(FrameResources& frame, const SceneStore& scene, uint32_t slot) {
+        auto* lights = static_cast<PointLight*>(frame.buffer->getMappedMemory());
+        const glm::vec4& color = scene.getLightColors()[slot];
+        lights[slot].position = glm::vec4(glm::vec3(scene.getLightPositions()[slot]), influenceRadius(color));
+        lights[slot].color = color;
+    }
+
+    bool LightBuffer::update(int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& changedSlots) {
+        CpuTracer::Scope trace{ "LightBuffer::update" };
+        const size_t lightCount = scene.lightCount();
+
+        if (!uploaded || uploadedVersion != scene.getStructureVersion()) {
+            for (auto& frame : frames) {
+                frame.fullUpload = true;
+                frame.pendingSlots.clear();
+            }
+            uploadedVersion = scene.getStructureVersion();
+            uploaded = true;
+        } else if (!changedSlots.empty()) {
+            // every frame in flight has its own copy of the lights
+            for (auto& frame : frames) {
+                if (frame.fullUpload) continue;
+                if (frame.pendingSlots.size() + changedSlots.size() > lightCount) {
+                    frame.fullUpload = true;
+                    frame.pendingSlots.clear();
+                } else {
+                    frame.pendingSlots.insert(
+                        frame.pendingSlots.end(), changedSlots.begin(), changedSlots.end());
+                }
+            }
+        }
+
+        FrameResources& frame = frames[frameIndex];
+        const bool reallocated = ensureCapacity(frame, lightCount);
+
+        if (frame.fullUpload) {
+            for (uint32_t slot = 0; slot < lightCount; ++slot) {
+                writeLight(frame, scene, slot);
+            }
+            frame.fullUpload = false;
+        } else {
+            for (uint32_t slot : frame.pendingSlots) {
+                writeLight(frame, scene, slot);
+            }
+        }
+        frame.pendingSlots.clear();
+
+        return reallocated;
+    }
+
+    VkDescriptorBufferInfo LightBuffer::descriptorInfo(int frameIndex) const {
+        return frames[frameIndex].buffer->descriptorInfo();
+    }
+}
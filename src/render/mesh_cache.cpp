@@ -0,0 +1,233 @@
+#include "mesh_cache.hpp"
+#include "cpu_tracer.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// std
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace enginev {
+
+    namespace {
+        constexpr char MAGIC[8] = { 'E', 'V', 'M', 'E', 'S', 'H', '\r', '\n' };
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t vertexSize;
+            uint64_t sourceHash;
+            uint64_t sourceSize;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            float bboxMin[3];
+            float bboxMax[3];
+            float boundingRadius;
+            uint32_t reserved;
+        };
+        // keeps the vertex and index arrays behind it 4-byte aligned
+        static_assert(sizeof(Header) % alignof(Model::Vertex) == 0, "meshcache header breaks vertex alignment");
+        static_assert(alignof(Model::Vertex) >= alignof(uint32_t), "meshcache indices need 4-byte alignment");
+
+        uint64_t fnv1a(const uint8_t* data, size_t size) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= data[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+    }
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path) {
+        HANDLE file = CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        fileHandle = file;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            return;
+        }
+
+        mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle) {
+            return;
+        }
+        mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (mapping) {
+            length = static_cast<size_t>(fileSize.QuadPart);
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if (mapping) UnmapViewOfFile(mapping);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle) CloseHandle(fileHandle);
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                mapping = mapped;
+                length = static_cast<size_t>(st.st_size);
+                // read front to back once, straight into the staging buffers
+                madvise(mapping, length, MADV_SEQUENTIAL);
+            }
+        }
+        // the mapping stays valid without the descriptor
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (mapping) munmap(mapping, length);
+    }
+#endif
+
+    std::unique_ptr<MeshCache> MeshCache::open(const std::string& modelPath) {
+        std::unique_ptr<MeshCache> cache{ new MeshCache(cachePath(modelPath)) };
+        const MappedFile& file = cache->file;
+        if (!file.isOpen() || file.size() < sizeof(Header)) {
+            return nullptr;
+        }
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.version != VERSION ||
+            header.vertexSize != sizeof(Model::Vertex)) {
+            return nullptr;
+        }
+
+        const uint64_t expectedSize = sizeof(Header) +
+            uint64_t{ header.vertexCount } * sizeof(Model::Vertex) +
+            uint64_t{ header.indexCount } * sizeof(uint32_t);
+        if (file.size() != expectedSize || header.vertexCount < 3) {
+            return nullptr;
+        }
+
+        // hashing is a single pass over the source, far cheaper than parsing it
+        MappedFile source{ modelPath };
+        if (!source.isOpen() ||
+            source.size() != header.sourceSize ||
+            fnv1a(source.data(), source.size()) != header.sourceHash) {
+            return nullptr;
+        }
+
+        const uint8_t* vertices = file.data() + sizeof(Header);
+        const uint8_t* indices = vertices + size_t{ header.vertexCount } * sizeof(Model::Vertex);
+
+        Model::MeshData& mesh = cache->mesh;
+        mesh.vertices = reinterpret_cast<const Model::Vertex*>(vertices);
+        mesh.vertexCount = header.vertexCount;
+        mesh.indices = header.indexCount > 0 ? reinterpret_cast<const uint32_t*>(indices) : nullptr;
+        mesh.indexCount = header.indexCount;
+        mesh.bboxMin = { header.bboxMin[0], header.bboxMin[1], header.bboxMin[2] };
+        mesh.bboxMax = { header.bboxMax[0], header.bboxMax[1], header.bboxMax[2] };
+        mesh.boundingRadius = header.boundingRadius;
+        return cache;
+    }
+
+    bool MeshCache::write(const std::string& modelPath, const Model::Builder& builder) {
+        Header header{};
+        {
+            MappedFile source{ modelPath };
+            if (!source.isOpen()) {
+                return false;
+            }
+            header.sourceHash = fnv1a(source.data(), source.size());
+            header.sourceSize = source.size();
+        }
+
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.vertexSize = sizeof(Model::Vertex);
+        header.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        header.indexCount = static_cast<uint32_t>(builder.indices.size());
+        for (int i = 0; i < 3; ++i) {
+            header.bboxMin[i] = builder.bboxMin[i];
+            header.bboxMax[i] = builder.bboxMax[i];
+        }
+        header.boundingRadius = builder.boundingRadius;
+
+        // written under a temporary name, so a reader never maps a
+        // half-written cache
+        const std::string path = cachePath(modelPath);
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(builder.vertices.data()),
+                static_cast<std::streamsize>(builder.vertices.size() * sizeof(Model::Vertex)));
+            out.write(reinterpret_cast<const char*>(builder.indices.data()),
+                static_cast<std::streamsize>(builder.indices.size() * sizeof(uint32_t)));
+            if (!out) {
+                out.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+
+#ifdef _WIN32
+        // rename() does not replace an existing file here
+        std::remove(path.c_str());
+#endif
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<LoadedMesh> LoadedMesh::load(const std::string& modelPath) {
+        CpuTracer::Scope trace{ "LoadedMesh::load" };
+        std::unique_ptr<LoadedMesh> loaded{ new LoadedMesh() };
+
+        loaded->cache = MeshCache::open(modelPath);
+        if (loaded->cache) {
+            loaded->mesh = loaded->cache->getMeshData();
+            return loaded;
+        }
+
+        Model::Builder& builder = loaded->builder;
+        builder.loadModel(modelPath);
+        if (!MeshCache::write(modelPath, builder)) {
+            std::cerr << "[MESH] cannot write " << MeshCache::cachePath(modelPath)
+                << ", the model is parsed on every load\n";
+        }
+
+        Model::MeshData& mesh = loaded->mesh;
+        mesh.vertices = builder.vertices.data();
+        mesh.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        mesh.indices = builder.indices.empty() ? nullptr : builder.indices.data();
+        mesh.indexCount = static_cast<uint32_t>(builder.indices.size());
+        mesh.bboxMin = builder.bboxMin;
+        mesh.bboxMax = builder.bboxMax;
+        mesh.boundingRadius = builder.boundingRadius;
+        return loaded;
+    }
+}
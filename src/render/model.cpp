@@ -1,4 +1,5 @@
 #include "model.hpp"
+#include "mesh_cache.hpp"
 #include "utils.hpp"
 
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -27,23 +28,29 @@ namespace std {
 }
 
 namespace enginev {
-	Model::Model(Device& device, const Model::Builder &builder, float radius) 
-		: device{device}, boundingRadius(radius) {
-		createVertexBuffers(builder.vertices);
-		createIndexBuffers(builder.indices);
+	Model::Model(Device& device, const Model::Builder &builder, float radius, UploadBatcher& uploader) 
+		: device{device}, boundingRadius(radius),
+		boundingCenter((builder.bboxMin + builder.bboxMax) * 0.5f) {
+		createVertexBuffers(builder.vertices.data(), static_cast<uint32_t>(builder.vertices.size()), uploader);
+		createIndexBuffers(builder.indices.data(), static_cast<uint32_t>(builder.indices.size()), uploader);
+	}
+
+	Model::Model(Device& device, const MeshData& mesh, UploadBatcher& uploader)
+		: device{device}, boundingRadius(mesh.boundingRadius),
+		boundingCenter((mesh.bboxMin + mesh.bboxMax) * 0.5f) {
+		createVertexBuffers(mesh.vertices, mesh.vertexCount, uploader);
+		createIndexBuffers(mesh.indices, mesh.indexCount, uploader);
 	}
 
 	Model::~Model() {}
 
 	std::unique_ptr<Model> Model::createModelFromFile(
-		Device& device, const std::string& filepath) {
-		Builder builder{};
-		builder.loadModel(filepath);
-
-		return std::make_unique<Model>(device, builder, builder.boundingRadius);
+		Device& device, const std::string& filepath, UploadBatcher& uploader) {
+		std::unique_ptr<LoadedMesh> mesh = LoadedMesh::load(filepath);
+		return std::make_unique<Model>(device, mesh->getMeshData(), uploader);
 	}
 
-	std::shared_ptr<Model> Model::createSkyboxCube(Device& device) {
+	std::shared_ptr<Model> Model::createSkyboxCube(Device& device, UploadBatcher& uploader) {
 		static const std::vector<glm::vec3> CUBE_POSITIONS = {
         {-1, -1, -1}, {1, -1, -1}, {1,  1, -1}, {-1,  1, -1},  // back
         {-1, -1,  1}, {1, -1,  1}, {1,  1,  1}, {-1,  1,  1}   // front
@@ -83,26 +90,15 @@ namespace enginev {
 		glm::vec3 extent = max - min;
 		builder.boundingRadius = glm::length(extent) * 0.5f;
 
-		return std::make_shared<Model>(device, builder, builder.boundingRadius);
+		return std::make_shared<Model>(device, builder, builder.boundingRadius, uploader);
 	}
 
-	void Model::createVertexBuffers(const std::vector<Vertex>& vertices) {
-		vertexCount = static_cast<uint32_t>(vertices.size());
+	void Model::createVertexBuffers(const Vertex* vertices, uint32_t count, UploadBatcher& uploader) {
+		vertexCount = count;
 		assert(vertexCount >= 3 && "Vertex count must be at least 3");
 		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
 		uint32_t vertexSize = sizeof(vertices[0]);
 
-		Buffer stagingBuffer{
-			device,
-			vertexSize,
-			vertexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void*)vertices.data());
-
 		vertexBuffer = std::make_unique<Buffer>(
 			device,
 			vertexSize,
@@ -110,7 +106,7 @@ namespace enginev {
 			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		device.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+		uploader.uploadBuffer(vertexBuffer->getBuffer(), vertices, bufferSize);
 	}
 
 	void Model::Builder::loadModel(const std::string& filepath) {
@@ -174,7 +170,7 @@ namespace enginev {
 
 		for (const auto& v : vertices) {
 			min = glm::min(min, v.position);
-			min = glm::max(max, v.position);
+			max = glm::max(max, v.position);
 		}
 
 		bboxMin = min;
@@ -184,8 +180,8 @@ namespace enginev {
 		boundingRadius = glm::length(extent) * 0.5f; 
 	}
 
-	void Model::createIndexBuffers(const std::vector<uint32_t>& indices) {
-		indexCount = static_cast<uint32_t>(indices.size());
+	void Model::createIndexBuffers(const uint32_t* indices, uint32_t count, UploadBatcher& uploader) {
+		indexCount = count;
 		hasIndexBuffer = indexCount > 0;
 
 		if (!hasIndexBuffer) {
@@ -195,17 +191,6 @@ namespace enginev {
 		VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
 		uint32_t indexSize = sizeof(indices[0]);
 
-		Buffer stagingBuffer{
-			device,
-			indexSize,
-			indexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void*)indices.data());
-
 		indexBuffer = std::make_unique<Buffer>(
 			device,
 			indexSize,
@@ -213,7 +198,7 @@ namespace enginev {
 			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		device.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+		uploader.uploadBuffer(indexBuffer->getBuffer(), indices, bufferSize);
 	}
 
 	void Model::draw(VkCommandBuffer commandBuffer) {
@@ -225,6 +210,34 @@ namespace enginev {
 		}
 	}
 
+	void Model::drawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
+		if (hasIndexBuffer) {
+			vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, 0, 0, firstInstance);
+		}
+		else {
+			vkCmdDraw(commandBuffer, vertexCount, instanceCount, 0, firstInstance);
+		}
+	}
+
+	VkDrawIndexedIndirectCommand Model::getIndirectCommand() const {
+		VkDrawIndexedIndirectCommand command{};
+		command.indexCount = hasIndexBuffer ? indexCount : vertexCount;
+		command.instanceCount = 0;
+		command.firstIndex = 0;
+		command.vertexOffset = 0;
+		command.firstInstance = 0;
+		return command;
+	}
+
+	void Model::drawIndirect(VkCommandBuffer commandBuffer, VkBuffer commandBufferHandle, VkDeviceSize offset) {
+		if (hasIndexBuffer) {
+			vkCmdDrawIndexedIndirect(commandBuffer, commandBufferHandle, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+		}
+		else {
+			vkCmdDrawIndirect(commandBuffer, commandBufferHandle, offset, 1, sizeof(VkDrawIndirectCommand));
+		}
+	}
+
 	void Model::bind(VkCommandBuffer commandBuffer) {
 		VkBuffer buffers[] = { vertexBuffer->getBuffer() };
 		VkDeviceSize offsets[] = { 0 };
@@ -252,4 +265,28 @@ namespace enginev {
 
 		return attributeDescriptions;
 	}
+
+	VkVertexInputBindingDescription Model::InstanceData::getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = BINDING;
+		bindingDescription.stride = sizeof(InstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+		return bindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> Model::InstanceData::getAttributeDescriptions() {
+		// each mat4 takes four consecutive vec4 locations
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+		for (uint32_t column = 0; column < 4; ++column) {
+			attributeDescriptions.push_back({
+				FIRST_LOCATION + column, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT,
+				static_cast<uint32_t>(offsetof(InstanceData, modelMatrix) + column * sizeof(glm::vec4)) });
+		}
+		for (uint32_t column = 0; column < 4; ++column) {
+			attributeDescriptions.push_back({
+				FIRST_LOCATION + 4 + column, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT,
+				static_cast<uint32_t>(offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec4)) });
+		}
+		return attributeDescriptions;
+	}
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 namespace enginev {
 
-    glm::mat4 TransformComponent::mat4() {
+    glm::mat4 TransformComponent::mat4() const {
         const float c3 = glm::cos(rotation.z);
         const float s3 = glm::sin(rotation.z);
         const float c2 = glm::cos(rotation.x);
@@ -31,7 +31,7 @@ namespace enginev {
             {translation.x, translation.y, translation.z, 1.0f} };
     }
 
-    glm::mat3 TransformComponent::normalMatrix() {
+    glm::mat3 TransformComponent::normalMatrix() const {
         const float c3 = glm::cos(rotation.z);
         const float s3 = glm::sin(rotation.z);
         const float c2 = glm::cos(rotation.x);
@@ -59,6 +59,12 @@ namespace enginev {
         };
     }
 
+    void TransformComponent::updateMatrices() {
+        worldMatrix = mat4();
+        worldNormalMatrix = glm::mat4{ normalMatrix() };
+        dirty = false;
+    }
+
     SimObject SimObject::makePointLight(
         float intensity, float radius, glm::vec3 color){
 
@@ -2,6 +2,7 @@
 
 #include "model.hpp"
 
+#include <array>
 #include <cassert>
 #include <fstream>
 #include <iostream>
@@ -54,8 +55,8 @@ namespace enginev {
         auto vertCode = readFile(vertFilepath);
         auto fragCode = readFile(fragFilepath);
 
-        createShaderModule(vertCode, &vertShaderModule);
-        createShaderModule(fragCode, &fragShaderModule);
+        vertShaderModule = createShaderModule(device.device(), vertCode);
+        fragShaderModule = createShaderModule(device.device(), fragCode);
 
         VkPipelineShaderStageCreateInfo shaderStages[2];
         shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -92,7 +93,15 @@ namespace enginev {
         pipelineInfo.pViewportState = &configInfo.viewportInfo;
         pipelineInfo.pRasterizationState = &configInfo.rasterizationInfo;
         pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
-        pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
+        // attachment states must be consecutive, so they are gathered here
+        std::array<VkPipelineColorBlendAttachmentState, 2> blendAttachments{
+            configInfo.colorBlendAttachment, configInfo.labelBlendAttachment };
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo = configInfo.colorBlendInfo;
+        if (configInfo.labelAttachment) {
+            colorBlendInfo.attachmentCount = static_cast<uint32_t>(blendAttachments.size());
+            colorBlendInfo.pAttachments = blendAttachments.data();
+        }
+        pipelineInfo.pColorBlendState = &colorBlendInfo;
         pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
         pipelineInfo.pDynamicState = &configInfo.dynamicStateInfo;
 
@@ -114,15 +123,17 @@ namespace enginev {
         }
     }
 
-    void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
+    VkShaderModule Pipeline::createShaderModule(VkDevice device, const std::vector<char>& code) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         createInfo.codeSize = code.size();
         createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-        if (vkCreateShaderModule(device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("failed to create shader module");
         }
+        return shaderModule;
     }
 
     void Pipeline::bind(VkCommandBuffer commandBuffer) {
@@ -203,6 +214,25 @@ namespace enginev {
         configInfo.attributeDescriptions = Model::Vertex::getAttributeDescriptions();
     }
 
+    void Pipeline::enableInstancing(PipelineConfigInfo& configInfo) {
+        configInfo.bindingDescriptions.push_back(Model::InstanceData::getBindingDescription());
+
+        auto instanceAttributes = Model::InstanceData::getAttributeDescriptions();
+        configInfo.attributeDescriptions.insert(
+            configInfo.attributeDescriptions.end(),
+            instanceAttributes.begin(),
+            instanceAttributes.end());
+    }
+
+    void Pipeline::enableLabelAttachment(PipelineConfigInfo& configInfo, bool writeLabel) {
+        configInfo.labelAttachment = true;
+
+        // integer attachments cannot be blended
+        configInfo.labelBlendAttachment = {};
+        configInfo.labelBlendAttachment.blendEnable = VK_FALSE;
+        configInfo.labelBlendAttachment.colorWriteMask = writeLabel ? VK_COLOR_COMPONENT_R_BIT : 0;
+    }
+
     void Pipeline::enablleAlphaBlending(PipelineConfigInfo& configInfo) {
         
         configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
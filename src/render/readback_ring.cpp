@@ -0,0 +1,157 @@
+#include "readback_ring.hpp"
+#include "cpu_tracer.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        // bounded waits so the worker notices shutdown even if a fence never
+        // signals (e.g. after a device loss)
+        constexpr uint64_t FENCE_TIMEOUT_NS = 100'000'000;
+    }
+
+    ReadbackRing::ReadbackRing(Device& device, size_t slotCount, Consumer consumer)
+        : device{ device }, consumer{ std::move(consumer) }, slots(slotCount) {
+        if (slotCount == 0) {
+            throw std::runtime_error("ReadbackRing needs at least one slot");
+        }
+
+        for (auto& slot : slots) {
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            if (vkCreateFence(device.device(), &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create readback fence");
+            }
+        }
+
+        worker = std::thread([this] { workerLoop(); });
+    }
+
+    ReadbackRing::~ReadbackRing() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        if (worker.joinable()) worker.join();
+
+        for (auto& slot : slots) {
+            destroyBuffer(slot);
+            vkDestroyFence(device.device(), slot.fence, nullptr);
+        }
+    }
+
+    void ReadbackRing::destroyBuffer(Slot& slot) {
+        if (slot.mapped) {
+            vkUnmapMemory(device.device(), slot.memory);
+            slot.mapped = nullptr;
+        }
+        if (slot.buffer) {
+            vkDestroyBuffer(device.device(), slot.buffer, nullptr);
+            slot.buffer = VK_NULL_HANDLE;
+        }
+        if (slot.memory) {
+            vkFreeMemory(device.device(), slot.memory, nullptr);
+            slot.memory = VK_NULL_HANDLE;
+        }
+        slot.capacity = 0;
+    }
+
+    void ReadbackRing::ensureCapacity(Slot& slot, VkDeviceSize size) {
+        if (slot.buffer && slot.capacity >= size) {
+            return;
+        }
+
+        // a free slot is not referenced by the GPU or the worker any more
+        destroyBuffer(slot);
+        // filled either by a copy or directly by a compute pass
+        device.createBuffer(
+            size,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            slot.buffer,
+            slot.memory);
+        vkMapMemory(device.device(), slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped);
+        slot.capacity = size;
+    }
+
+    ReadbackRing::Slot* ReadbackRing::acquire(VkDeviceSize size, uint32_t width, uint32_t height) {
+        Slot* found = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& slot : slots) {
+                if (slot.free) {
+                    slot.free = false;
+                    found = &slot;
+                    break;
+                }
+            }
+        }
+
+        if (!found) {
+            ++droppedFrames;
+            return nullptr;
+        }
+
+        ensureCapacity(*found, size);
+        vkResetFences(device.device(), 1, &found->fence);
+        found->size = size;
+        found->width = width;
+        found->height = height;
+        return found;
+    }
+
+    void ReadbackRing::submit(Slot* slot) {
+        slot->captureTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // an empty batch: its fence signals after all earlier submissions
+        if (vkQueueSubmit(device.graphicsQueue(), 0, nullptr, slot->fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit readback fence");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(slot);
+        }
+        cv.notify_one();
+    }
+
+    void ReadbackRing::workerLoop() {
+        CpuTracer::setThreadName("readback");
+        for (;;) {
+            Slot* slot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (stopping) return;
+                slot = pending.front();
+                pending.pop_front();
+            }
+
+            VkResult result = VK_TIMEOUT;
+            while (result == VK_TIMEOUT) {
+                result = vkWaitForFences(device.device(), 1, &slot->fence, VK_TRUE, FENCE_TIMEOUT_NS);
+                if (result == VK_TIMEOUT) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (stopping) return;
+                }
+            }
+
+            if (result == VK_SUCCESS) {
+                Frame frame{};
+                frame.data = slot->mapped;
+                frame.size = static_cast<size_t>(slot->size);
+                frame.width = slot->width;
+                frame.height = slot->height;
+                frame.captureTimeNs = slot->captureTimeNs;
+                consumer(frame);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            slot->free = true;
+        }
+    }
+}
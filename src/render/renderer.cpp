@@ -1,4 +1,5 @@
 #include "renderer.hpp"
+#include "cpu_tracer.hpp"
 
 // std
 #include <array>
@@ -8,17 +9,23 @@
 namespace enginev {
 
     Renderer::Renderer(Window& window, Device& device)
-        : window{ window }, device{ device } {
+        : window{ &window }, device{ device } {
         recreateSwapChain();
         createCommandBuffers();
     }
 
+    Renderer::Renderer(Device& device, VkExtent2D extent)
+        : window{ nullptr }, device{ device } {
+        offscreen = std::make_unique<OffscreenTarget>(device, extent);
+        createCommandBuffers();
+    }
+
     Renderer::~Renderer() { freeCommandBuffers(); }
 
     void Renderer::recreateSwapChain() {
-        auto extent = window.getExtent();
+        auto extent = window->getExtent();
         while (extent.width == 0 || extent.height == 0) {
-            extent = window.getExtent();
+            extent = window->getExtent();
             glfwWaitEvents();
         }
         vkDeviceWaitIdle(device.device());
@@ -63,7 +70,14 @@ namespace enginev {
     VkCommandBuffer Renderer::beginFrame() {
         assert(!isFrameStarted && "Can't call beginFrame while already in progress");
 
-        auto result = swapChain->acquireNextImage(&currentImageIndex);
+        VkResult result;
+        {
+            // waits for the frame that last used this command buffer
+            CpuTracer::Scope trace{ "Renderer::beginFrame acquire" };
+            result = offscreen
+                ? offscreen->acquireNextImage(&currentImageIndex)
+                : swapChain->acquireNextImage(&currentImageIndex);
+        }
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
             return nullptr;
@@ -82,6 +96,8 @@ namespace enginev {
         if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
             throw std::runtime_error("failed to begin recording command buffer!");
         }
+
+        ++frameNumber;
         return commandBuffer;
     }
 
@@ -92,10 +108,20 @@ namespace enginev {
             throw std::runtime_error("failed to record command buffer!");
         }
 
+        CpuTracer::Scope trace{ "Renderer::endFrame submit" };
+        if (offscreen) {
+            if (offscreen->submitCommandBuffers(&commandBuffer, &currentImageIndex) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit draw command buffer!");
+            }
+            isFrameStarted = false;
+            currentFrameIndex = (currentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+            return;
+        }
+
         auto result = swapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
-            window.wasWindowResized()) {
-            window.resetWindowResizedFlag();
+            window->wasWindowResized()) {
+            window->resetWindowResizedFlag();
             recreateSwapChain();
         }
         else if (result != VK_SUCCESS) {
@@ -112,13 +138,20 @@ namespace enginev {
             commandBuffer == getCurrentCommandBuffer() &&
             "Can't begin render pass on command buffer from a different frame");
 
+        if (offscreen) {
+            offscreen->beginRenderPass(commandBuffer, currentImageIndex);
+            return;
+        }
+
+        const VkExtent2D extent = swapChain->getSwapChainExtent();
+
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassInfo.renderPass = swapChain->getRenderPass();
         renderPassInfo.framebuffer = swapChain->getFrameBuffer(currentImageIndex);
 
         renderPassInfo.renderArea.offset = { 0, 0 };
-        renderPassInfo.renderArea.extent = swapChain->getSwapChainExtent();
+        renderPassInfo.renderArea.extent = extent;
 
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = { 0.01f, 0.01f, 0.01f, 1.0f };
@@ -131,16 +164,21 @@ namespace enginev {
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(swapChain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(swapChain->getSwapChainExtent().height);
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        VkRect2D scissor{ {0, 0}, swapChain->getSwapChainExtent() };
+        VkRect2D scissor{ {0, 0}, extent };
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
     void Renderer::copySwapImageToBuffer(VkCommandBuffer cmd, VkBuffer dstBuffer) {
+        if (offscreen) {
+            offscreen->copyImageToBuffer(cmd, currentImageIndex, dstBuffer);
+            return;
+        }
+
         const VkExtent2D e = swapChain->getSwapChainExtent();
         VkBufferImageCopy region{};
         region.bufferOffset = 0;
@@ -160,9 +198,35 @@ namespace enginev {
             dstBuffer,
             1, &region);
 
+        // make the copy visible to host reads once the frame's fence signals
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = dstBuffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        transitionSwapImageToPresent(cmd);
+    }
+
+    void Renderer::transitionSwapImageToPresent(VkCommandBuffer cmd) {
+        if (offscreen) {
+            return;
+        }
+
         VkImageMemoryBarrier toPresent{};
         toPresent.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        toPresent.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        // also covers the frames that skip the readback copy
+        toPresent.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
         toPresent.dstAccessMask = 0;
         toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
@@ -171,7 +235,7 @@ namespace enginev {
 
         vkCmdPipelineBarrier(
             cmd,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
             0, 0, nullptr, 0, nullptr, 1, &toPresent);
     }
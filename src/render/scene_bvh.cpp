@@ -0,0 +1,231 @@
+#include "scene_bvh.hpp"
+#include "frustum_cull.hpp"
+#include "cpu_tracer.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t ALL_PLANES = (1u << 6) - 1;
+        constexpr int MAX_STACK = 64;
+    }
+
+    SceneBvh::SceneBvh(const SceneStore& store) : store{ store } {}
+
+    void SceneBvh::update(const std::vector<uint32_t>& changedSlots) {
+        CpuTracer::Scope trace{ "SceneBvh::update" };
+        if (!built || builtVersion != store.getStructureVersion()) {
+            rebuild();
+            return;
+        }
+        if (!changedSlots.empty()) {
+            refit(changedSlots);
+        }
+    }
+
+    void SceneBvh::rebuild() {
+        const auto& modelHandles = store.getModelHandles();
+        const uint32_t objectCount = static_cast<uint32_t>(store.objectCount());
+
+        nodes.clear();
+        items.clear();
+        itemOfSlot.assign(objectCount, INVALID_NODE);
+        leafOfSlot.assign(objectCount, INVALID_NODE);
+
+        items.reserve(objectCount);
+        for (uint32_t slot = 0; slot < objectCount; ++slot) {
+            if (modelHandles[slot] != SceneStore::NO_MODEL) {
+                items.push_back(slot);
+            }
+        }
+
+        packedX.resize(items.size());
+        packedY.resize(items.size());
+        packedZ.resize(items.size());
+        packedR.resize(items.size());
+
+        if (!items.empty()) {
+            nodes.reserve(2 * (items.size() / MAX_LEAF_ITEMS + 1));
+            buildNode(0, static_cast<uint32_t>(items.size()), INVALID_NODE);
+        }
+
+        builtVersion = store.getStructureVersion();
+        built = true;
+    }
+
+    void SceneBvh::packItem(uint32_t item) {
+        const glm::vec4& b = store.getBounds()[items[item]];
+        packedX[item] = b.x;
+        packedY[item] = b.y;
+        packedZ[item] = b.z;
+        packedR[item] = b.w;
+    }
+
+    void SceneBvh::computeLeafBounds(Node& node) const {
+        glm::vec3 bmin(std::numeric_limits<float>::max());
+        glm::vec3 bmax(std::numeric_limits<float>::lowest());
+        for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i) {
+            const glm::vec3 c{ packedX[i], packedY[i], packedZ[i] };
+            bmin = glm::min(bmin, c - packedR[i]);
+            bmax = glm::max(bmax, c + packedR[i]);
+        }
+        node.boundsMin = bmin;
+        node.boundsMax = bmax;
+    }
+
+    uint32_t SceneBvh::buildNode(uint32_t first, uint32_t count, uint32_t parent) {
+        const uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        nodes[index].firstItem = first;
+        nodes[index].itemCount = count;
+        nodes[index].parent = parent;
+
+        if (count <= MAX_LEAF_ITEMS) {
+            for (uint32_t i = first; i < first + count; ++i) {
+                itemOfSlot[items[i]] = i;
+                leafOfSlot[items[i]] = index;
+                packItem(i);
+            }
+            computeLeafBounds(nodes[index]);
+            return index;
+        }
+
+        // split at the median centroid along the longest centroid axis
+        const auto& bounds = store.getBounds();
+        glm::vec3 cmin(std::numeric_limits<float>::max());
+        glm::vec3 cmax(std::numeric_limits<float>::lowest());
+        for (uint32_t i = first; i < first + count; ++i) {
+            const glm::vec3 c = glm::vec3(bounds[items[i]]);
+            cmin = glm::min(cmin, c);
+            cmax = glm::max(cmax, c);
+        }
+        const glm::vec3 extent = cmax - cmin;
+        int axis = 0;
+        if (extent.y > extent[axis]) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+
+        const uint32_t half = count / 2;
+        auto begin = items.begin() + first;
+        std::nth_element(begin, begin + half, begin + count,
+            [&bounds, axis](uint32_t a, uint32_t b) {
+                return bounds[a][axis] < bounds[b][axis];
+            });
+
+        const uint32_t left = buildNode(first, half, index);
+        const uint32_t right = buildNode(first + half, count - half, index);
+
+        Node& node = nodes[index];
+        node.left = left;
+        node.right = right;
+        node.boundsMin = glm::min(nodes[left].boundsMin, nodes[right].boundsMin);
+        node.boundsMax = glm::max(nodes[left].boundsMax, nodes[right].boundsMax);
+        return index;
+    }
+
+    void SceneBvh::refit(const std::vector<uint32_t>& changedSlots) {
+        if (++refitCounter == 0) {
+            for (auto& node : nodes) node.refitStamp = 0;
+            refitCounter = 1;
+        }
+
+        refitQueue.clear();
+        for (uint32_t slot : changedSlots) {
+            if (slot >= leafOfSlot.size() || leafOfSlot[slot] == INVALID_NODE) continue;
+            packItem(itemOfSlot[slot]);
+
+            uint32_t index = leafOfSlot[slot];
+            while (index != INVALID_NODE && nodes[index].refitStamp != refitCounter) {
+                nodes[index].refitStamp = refitCounter;
+                refitQueue.push_back(index);
+                index = nodes[index].parent;
+            }
+        }
+
+        // children are always stored after their parent, so refitting in
+        // decreasing index order visits every child before its parent
+        std::sort(refitQueue.begin(), refitQueue.end(), std::greater<uint32_t>());
+        for (uint32_t index : refitQueue) {
+            Node& node = nodes[index];
+            if (node.isLeaf()) {
+                computeLeafBounds(node);
+            } else {
+                node.boundsMin = glm::min(nodes[node.left].boundsMin, nodes[node.right].boundsMin);
+                node.boundsMax = glm::max(nodes[node.left].boundsMax, nodes[node.right].boundsMax);
+            }
+        }
+    }
+
+    void SceneBvh::query(const Frustum& frustum, std::vector<uint32_t>& outSlots) const {
+        if (nodes.empty()) return;
+
+        uint32_t leafVisible[MAX_LEAF_ITEMS];
+
+        struct StackEntry {
+            uint32_t node;
+            uint32_t planeMask;
+        };
+        StackEntry stack[MAX_STACK];
+        int stackSize = 0;
+        stack[stackSize++] = { 0, ALL_PLANES };
+
+        while (stackSize > 0) {
+            const StackEntry entry = stack[--stackSize];
+            const Node& node = nodes[entry.node];
+
+            const glm::vec3 center = (node.boundsMin + node.boundsMax) * 0.5f;
+            const glm::vec3 halfExtent = (node.boundsMax - node.boundsMin) * 0.5f;
+
+            uint32_t mask = entry.planeMask;
+            bool outside = false;
+            for (int p = 0; p < 6; ++p) {
+                if (!(mask & (1u << p))) continue;
+
+                const glm::vec3 n = glm::vec3(frustum.planes[p]);
+                const float dist = glm::dot(n, center) + frustum.planes[p].w;
+                const float radius = glm::dot(halfExtent, glm::abs(n));
+                if (dist + radius < 0.f) {
+                    outside = true;
+                    break;
+                }
+                if (dist - radius >= 0.f) {
+                    mask &= ~(1u << p);
+                }
+            }
+            if (outside) continue;
+
+            if (mask == 0) {
+                // whole subtree is inside every plane
+                outSlots.insert(
+                    outSlots.end(),
+                    items.begin() + node.firstItem,
+                    items.begin() + node.firstItem + node.itemCount);
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                const uint32_t first = node.firstItem;
+                const size_t visible = cullSpheres(
+                    frustum,
+                    packedX.data() + first, packedY.data() + first,
+                    packedZ.data() + first, packedR.data() + first,
+                    node.itemCount,
+                    leafVisible,
+                    first);
+                for (size_t i = 0; i < visible; ++i) {
+                    outSlots.push_back(items[leafVisible[i]]);
+                }
+                continue;
+            }
+
+            stack[stackSize++] = { node.right, mask };
+            stack[stackSize++] = { node.left, mask };
+        }
+    }
+}
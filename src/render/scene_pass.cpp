@@ -1,9 +1,11 @@
 #include "scene_pass.hpp"
 
+#include <vector>
+
 namespace enginev {
 
-    ScenePass::ScenePass(Device& device)
-        : device{ device } {}
+    ScenePass::ScenePass(Device& device, bool labelAttachment)
+        : device{ device }, labelAttachment{ labelAttachment } {}
 
     ScenePass::~ScenePass() {
         destroy();
@@ -30,12 +32,7 @@ namespace enginev {
             sceneColorView = VK_NULL_HANDLE;
         }
         if (sceneColorImage) {
-            vkDestroyImage(device.device(), sceneColorImage, nullptr);
-            sceneColorImage = VK_NULL_HANDLE;
-        }
-        if (sceneColorMemory) {
-            vkFreeMemory(device.device(), sceneColorMemory, nullptr);
-            sceneColorMemory = VK_NULL_HANDLE;
+            device.destroyImage(sceneColorImage, sceneColorAllocation);
         }
 
         if (sceneDepthView) {
@@ -43,12 +40,7 @@ namespace enginev {
             sceneDepthView = VK_NULL_HANDLE;
         }
         if (sceneDepthImage) {
-            vkDestroyImage(device.device(), sceneDepthImage, nullptr);
-            sceneDepthImage = VK_NULL_HANDLE;
-        }
-        if (sceneDepthMemory) {
-            vkFreeMemory(device.device(), sceneDepthMemory, nullptr);
-            sceneDepthMemory = VK_NULL_HANDLE;
+            device.destroyImage(sceneDepthImage, sceneDepthAllocation);
         }
 
         if (sceneDepthSampler) {
@@ -56,6 +48,14 @@ namespace enginev {
             sceneDepthSampler = VK_NULL_HANDLE;
         }
 
+        if (sceneLabelView) {
+            vkDestroyImageView(device.device(), sceneLabelView, nullptr);
+            sceneLabelView = VK_NULL_HANDLE;
+        }
+        if (sceneLabelImage) {
+            device.destroyImage(sceneLabelImage, sceneLabelAllocation);
+        }
+
         sceneDepthFormat = VK_FORMAT_UNDEFINED;
         sceneExtent = { 0,0 };
     }
@@ -68,6 +68,9 @@ namespace enginev {
 
         createSceneColorTarget(extent);
         createSceneDepthTarget(extent);
+        if (labelAttachment) {
+            createSceneLabelTarget(extent);
+        }
         createSceneRenderPass(sceneColorFormat, sceneDepthFormat);
         createSceneFramebuffer();
     }
@@ -93,7 +96,7 @@ namespace enginev {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             sceneColorImage,
-            sceneColorMemory
+            sceneColorAllocation
         );
 
         VkImageViewCreateInfo viewInfo{};
@@ -148,7 +151,7 @@ namespace enginev {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             sceneDepthImage,
-            sceneDepthMemory
+            sceneDepthAllocation
         );
 
         VkImageViewCreateInfo viewInfo{};
@@ -185,6 +188,45 @@ namespace enginev {
         }
     }
 
+    void ScenePass::createSceneLabelTarget(VkExtent2D extent) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = LABEL_FORMAT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage =
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        device.createImageWithInfo(
+            imageInfo,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            sceneLabelImage,
+            sceneLabelAllocation
+        );
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = sceneLabelImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = LABEL_FORMAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device.device(), &viewInfo, nullptr, &sceneLabelView) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create scene label image view");
+        }
+    }
+
     void ScenePass::createSceneRenderPass(VkFormat colorFormat, VkFormat depthFormat) {
         VkAttachmentDescription colorAttachment{};
         colorAttachment.format = colorFormat;
@@ -200,15 +242,30 @@ namespace enginev {
         depthAttachment.format = depthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        // sampled afterwards by the post pass and the depth export
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
-        VkAttachmentReference colorRef{};
-        colorRef.attachment = 0;
-        colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        // 0 is background; the label image is only ever copied out
+        VkAttachmentDescription labelAttachmentDesc{};
+        labelAttachmentDesc.format = LABEL_FORMAT;
+        labelAttachmentDesc.samples = VK_SAMPLE_COUNT_1_BIT;
+        labelAttachmentDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        labelAttachmentDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        labelAttachmentDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        labelAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        labelAttachmentDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        labelAttachmentDesc.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        // fragment output 0 is the color, output 1 the label
+        std::array<VkAttachmentReference, 2> colorRefs{};
+        colorRefs[0].attachment = 0;
+        colorRefs[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorRefs[1].attachment = 2;
+        colorRefs[1].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
         VkAttachmentReference depthRef{};
         depthRef.attachment = 1;
@@ -216,16 +273,22 @@ namespace enginev {
 
         VkSubpassDescription subpass{};
         subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pColorAttachments = &colorRef;
+        subpass.colorAttachmentCount = labelAttachment ? 2 : 1;
+        subpass.pColorAttachments = colorRefs.data();
         subpass.pDepthStencilAttachment = &depthRef;
 
         std::array<VkSubpassDependency, 2> deps{};
 
         deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
         deps[0].dstSubpass = 0;
-        deps[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        // the previous frame's targets are also read by compute passes
+        deps[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
         deps[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        if (labelAttachment) {
+            // the label copy of the previous frame
+            deps[0].srcStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+            deps[0].srcAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
+        }
         deps[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -240,8 +303,15 @@ namespace enginev {
                                 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
         deps[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         deps[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        if (labelAttachment) {
+            deps[1].dstStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+            deps[1].dstAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
+        }
 
-        std::array<VkAttachmentDescription, 2> attachments{ colorAttachment, depthAttachment };
+        std::vector<VkAttachmentDescription> attachments{ colorAttachment, depthAttachment };
+        if (labelAttachment) {
+            attachments.push_back(labelAttachmentDesc);
+        }
 
         VkRenderPassCreateInfo rpInfo{};
         rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -258,7 +328,10 @@ namespace enginev {
     }
 
     void ScenePass::createSceneFramebuffer() {
-        std::array<VkImageView, 2> attachments = { sceneColorView, sceneDepthView };
+        std::vector<VkImageView> attachments = { sceneColorView, sceneDepthView };
+        if (labelAttachment) {
+            attachments.push_back(sceneLabelView);
+        }
 
         VkFramebufferCreateInfo fbInfo{};
         fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -275,9 +348,10 @@ namespace enginev {
     }
 
     void ScenePass::begin(VkCommandBuffer cmd) {
-        VkClearValue clears[2]{};
+        VkClearValue clears[3]{};
         clears[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
         clears[1].depthStencil = { 1.0f, 0 };
+        clears[2].color.uint32[0] = 0;
 
         VkRenderPassBeginInfo rpInfo{};
         rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -285,7 +359,7 @@ namespace enginev {
         rpInfo.framebuffer = sceneFramebuffer;
         rpInfo.renderArea.offset = { 0, 0 };
         rpInfo.renderArea.extent = sceneExtent;
-        rpInfo.clearValueCount = 2;
+        rpInfo.clearValueCount = labelAttachment ? 3 : 2;
         rpInfo.pClearValues = clears;
 
         vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -310,4 +384,46 @@ namespace enginev {
         vkCmdEndRenderPass(cmd);
     }
 
+    void ScenePass::copyLabelToBuffer(VkCommandBuffer cmd, VkBuffer dstBuffer) {
+        // the render pass dependency already orders the copy after the
+        // label writes
+        VkBufferImageCopy region{};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { sceneExtent.width, sceneExtent.height, 1 };
+
+        vkCmdCopyImageToBuffer(
+            cmd,
+            sceneLabelImage,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            dstBuffer,
+            1,
+            &region);
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = dstBuffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            0, nullptr,
+            1, &barrier,
+            0, nullptr);
+    }
+
 } // namespace enginev
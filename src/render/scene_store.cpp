@@ -0,0 +1,262 @@
+#include "scene_store.hpp"
+#include "cpu_tracer.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cassert>
+#include <stdexcept>
+
+namespace enginev {
+
+    void SceneStore::setSlot(std::vector<uint32_t>& slots, id_t id, uint32_t slot) {
+        if (id >= slots.size()) {
+            slots.resize(static_cast<size_t>(id) + 1, INVALID_SLOT);
+        }
+        slots[id] = slot;
+    }
+
+    uint32_t SceneStore::findSlot(const std::vector<uint32_t>& slots, id_t id) {
+        return id < slots.size() ? slots[id] : INVALID_SLOT;
+    }
+
+    uint32_t SceneStore::objectSlot(id_t id) const {
+        return findSlot(objectSlots, id);
+    }
+
+    uint32_t SceneStore::lightSlot(id_t id) const {
+        return findSlot(lightSlots, id);
+    }
+
+    bool SceneStore::contains(id_t id) const {
+        return objectSlot(id) != INVALID_SLOT || lightSlot(id) != INVALID_SLOT;
+    }
+
+    void SceneStore::reserve(size_t objectCount, size_t lightCount) {
+        objectIds.reserve(objectCount);
+        transforms.reserve(objectCount);
+        colors.reserve(objectCount);
+        modelHandles.reserve(objectCount);
+        semanticClasses.reserve(objectCount);
+        bounds.reserve(objectCount);
+
+        lightIds.reserve(lightCount);
+        lightPositions.reserve(lightCount);
+        lightColors.reserve(lightCount);
+        lightDirty.reserve(lightCount);
+    }
+
+    uint32_t SceneStore::objectLabel(uint32_t slot) const {
+        constexpr uint32_t MAX_LABEL = (1u << 24) - 1;
+        const uint32_t label = labelMode == LabelMode::Semantic
+            ? semanticClasses[slot]
+            : objectIds[slot] + 1;
+        return label < MAX_LABEL ? label : MAX_LABEL;
+    }
+
+    uint32_t SceneStore::getModelHandle(const std::shared_ptr<Model>& model) {
+        if (!model) return NO_MODEL;
+
+        auto it = modelHandleLookup.find(model.get());
+        if (it != modelHandleLookup.end()) {
+            return it->second;
+        }
+
+        uint32_t handle = static_cast<uint32_t>(models.size());
+        models.push_back(model);
+        modelHandleLookup.emplace(model.get(), handle);
+        return handle;
+    }
+
+    SceneStore::id_t SceneStore::add(SimObject&& obj) {
+        const id_t id = obj.getId();
+        if (contains(id)) {
+            throw std::runtime_error("SceneStore: object id already added");
+        }
+        ++structureVersion;
+
+        if (obj.pointLight) {
+            uint32_t slot = static_cast<uint32_t>(lightIds.size());
+            lightIds.push_back(id);
+            lightPositions.push_back(glm::vec4(obj.transform.translation, obj.transform.scale.x));
+            lightColors.push_back(glm::vec4(obj.color, obj.pointLight->lightIntensity));
+            lightDirty.push_back(0);
+            setSlot(lightSlots, id, slot);
+        }
+
+        if (obj.model || !obj.pointLight) {
+            uint32_t slot = static_cast<uint32_t>(objectIds.size());
+            objectIds.push_back(id);
+            transforms.push_back(obj.transform);
+            transforms.back().updateMatrices();
+            colors.push_back(obj.color);
+            modelHandles.push_back(getModelHandle(obj.model));
+            semanticClasses.push_back(obj.semanticClass);
+            bounds.push_back(glm::vec4(0.f));
+            setSlot(objectSlots, id, slot);
+            updateBounds(slot);
+        }
+
+        return id;
+    }
+
+    void SceneStore::remove(id_t id) {
+        if (!contains(id)) return;
+        ++structureVersion;
+
+        uint32_t slot = objectSlot(id);
+        if (slot != INVALID_SLOT) {
+            uint32_t last = static_cast<uint32_t>(objectIds.size() - 1);
+            if (slot != last) {
+                objectIds[slot] = objectIds[last];
+                transforms[slot] = transforms[last];
+                colors[slot] = colors[last];
+                modelHandles[slot] = modelHandles[last];
+                semanticClasses[slot] = semanticClasses[last];
+                bounds[slot] = bounds[last];
+                objectSlots[objectIds[slot]] = slot;
+            }
+            objectIds.pop_back();
+            transforms.pop_back();
+            colors.pop_back();
+            modelHandles.pop_back();
+            semanticClasses.pop_back();
+            bounds.pop_back();
+            objectSlots[id] = INVALID_SLOT;
+        }
+
+        slot = lightSlot(id);
+        if (slot != INVALID_SLOT) {
+            uint32_t last = static_cast<uint32_t>(lightIds.size() - 1);
+            if (slot != last) {
+                lightIds[slot] = lightIds[last];
+                lightPositions[slot] = lightPositions[last];
+                lightColors[slot] = lightColors[last];
+                lightDirty[slot] = lightDirty[last];
+                lightSlots[lightIds[slot]] = slot;
+            }
+            lightIds.pop_back();
+            lightPositions.pop_back();
+            lightColors.pop_back();
+            lightDirty.pop_back();
+            lightSlots[id] = INVALID_SLOT;
+        }
+    }
+
+    void SceneStore::clear() {
+        ++structureVersion;
+
+        objectSlots.clear();
+        objectIds.clear();
+        transforms.clear();
+        colors.clear();
+        modelHandles.clear();
+        semanticClasses.clear();
+        bounds.clear();
+
+        dirtyIds.clear();
+        flushedSlots.clear();
+
+        lightSlots.clear();
+        lightIds.clear();
+        lightPositions.clear();
+        lightColors.clear();
+        lightDirty.clear();
+
+        dirtyLightIds.clear();
+        flushedLightSlots.clear();
+
+        models.clear();
+        modelHandleLookup.clear();
+    }
+
+    void SceneStore::setTransform(id_t id, const TransformComponent& transform) {
+        uint32_t slot = objectSlot(id);
+        if (slot != INVALID_SLOT) {
+            TransformComponent& dst = transforms[slot];
+            dst.translation = transform.translation;
+            dst.rotation = transform.rotation;
+            dst.scale = transform.scale;
+            if (!dst.dirty) {
+                dst.dirty = true;
+                dirtyIds.push_back(id);
+            }
+        }
+
+        slot = lightSlot(id);
+        if (slot != INVALID_SLOT) {
+            lightPositions[slot] = glm::vec4(transform.translation, transform.scale.x);
+            markLightDirty(slot);
+        }
+    }
+
+    const std::vector<uint32_t>& SceneStore::flushTransforms() {
+        CpuTracer::Scope trace{ "SceneStore::flushTransforms" };
+        flushedSlots.clear();
+
+        for (id_t id : dirtyIds) {
+            const uint32_t slot = objectSlot(id);
+            if (slot == INVALID_SLOT || !transforms[slot].dirty) continue;
+
+            transforms[slot].updateMatrices();
+            updateBounds(slot);
+            flushedSlots.push_back(slot);
+        }
+        dirtyIds.clear();
+
+        return flushedSlots;
+    }
+
+    void SceneStore::setLightPosition(id_t id, const glm::vec3& position) {
+        uint32_t slot = lightSlot(id);
+        assert(slot != INVALID_SLOT && "Object is not a point light");
+        lightPositions[slot] = glm::vec4(position, lightPositions[slot].w);
+        markLightDirty(slot);
+    }
+
+    void SceneStore::setLightColor(id_t id, const glm::vec3& color, float intensity) {
+        uint32_t slot = lightSlot(id);
+        assert(slot != INVALID_SLOT && "Object is not a point light");
+        lightColors[slot] = glm::vec4(color, intensity);
+        markLightDirty(slot);
+    }
+
+    void SceneStore::markLightDirty(uint32_t slot) {
+        if (!lightDirty[slot]) {
+            lightDirty[slot] = 1;
+            dirtyLightIds.push_back(lightIds[slot]);
+        }
+    }
+
+    const std::vector<uint32_t>& SceneStore::flushLights() {
+        flushedLightSlots.clear();
+
+        for (id_t id : dirtyLightIds) {
+            const uint32_t slot = lightSlot(id);
+            if (slot == INVALID_SLOT || !lightDirty[slot]) continue;
+
+            lightDirty[slot] = 0;
+            flushedLightSlots.push_back(slot);
+        }
+        dirtyLightIds.clear();
+
+        return flushedLightSlots;
+    }
+
+    void SceneStore::updateBounds(uint32_t slot) {
+        const TransformComponent& transform = transforms[slot];
+        const uint32_t handle = modelHandles[slot];
+
+        if (handle == NO_MODEL) {
+            bounds[slot] = glm::vec4(transform.translation, 0.f);
+            return;
+        }
+
+        const Model* model = models[handle].get();
+        glm::vec3 center = glm::vec3(transform.worldMatrix * glm::vec4(model->boundingCenter, 1.f));
+        glm::vec3 absScale = glm::abs(transform.scale);
+        float radius = model->boundingRadius * glm::max(absScale.x, glm::max(absScale.y, absScale.z));
+        bounds[slot] = glm::vec4(center, radius);
+    }
+}
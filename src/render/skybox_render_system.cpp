@@ -1,4 +1,5 @@
 #include "skybox_render_system.hpp"
+#include "cpu_tracer.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -11,12 +12,13 @@
 
 namespace enginev {
     SkyboxRenderSystem::SkyboxRenderSystem(
-        Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
+        Device& device, UploadBatcher& uploader, VkRenderPass renderPass,
+        VkDescriptorSetLayout globalSetLayout, bool labelAttachment)
         : device{ device } {
         createPipelineLayout(globalSetLayout);
-        createPipeline(renderPass);
+        createPipeline(renderPass, labelAttachment);
 
-        skyboxModel = Model::createModelFromFile(device, "../models/cube.obj");
+        skyboxModel = Model::createModelFromFile(device, "../models/cube.obj", uploader);
     }
 
     SkyboxRenderSystem::~SkyboxRenderSystem() {
@@ -39,7 +41,7 @@ namespace enginev {
         }
     }
 
-    void SkyboxRenderSystem::createPipeline(VkRenderPass renderPass) {
+    void SkyboxRenderSystem::createPipeline(VkRenderPass renderPass, bool labelAttachment) {
         assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
         PipelineConfigInfo pipelineConfig{};
@@ -47,6 +49,10 @@ namespace enginev {
 
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
+        if (labelAttachment) {
+            // drawn into the scene pass, but not an object
+            Pipeline::enableLabelAttachment(pipelineConfig, false);
+        }
 
         pipelineConfig.depthStencilInfo.depthTestEnable = VK_TRUE;
         pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
@@ -81,6 +87,7 @@ namespace enginev {
     }
 
     void SkyboxRenderSystem::render(FrameInfo& frameInfo) {
+        CpuTracer::Scope trace{ "SkyboxRenderSystem::render", frameInfo.viewIndex };
        
         pipeline->bind(frameInfo.commandBuffer);
 
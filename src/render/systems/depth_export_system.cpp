@@ -0,0 +1,201 @@
+#include "depth_export_system.hpp"
+#include "pipeline.hpp"
+#include "swap_chain.hpp"
+
+#include <vulkan/vulkan.h>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t LOCAL_SIZE = 64;
+
+        struct DepthPushConstant {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t encoding = 0;
+            uint32_t wordCount = 0;
+            float nearPlane = 0.f;
+            float farPlane = 0.f;
+        };
+    }
+
+    bool DepthExportSystem::parseEncoding(const std::string& name, DepthEncoding& encoding) {
+        for (DepthEncoding e : { DepthEncoding::FLOAT32, DepthEncoding::UINT16 }) {
+            if (name == encodingName(e)) {
+                encoding = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* DepthExportSystem::encodingName(DepthEncoding encoding) {
+        return encoding == DepthEncoding::UINT16 ? "16UC1" : "32FC1";
+    }
+
+    uint32_t DepthExportSystem::bytesPerPixel(DepthEncoding encoding) {
+        return encoding == DepthEncoding::UINT16 ? 2 : 4;
+    }
+
+    DepthExportSystem::DepthExportSystem(Device& device, DepthEncoding encoding, uint32_t viewCount)
+        : device(device), encoding(encoding), viewCount(viewCount)
+    {
+        if (viewCount == 0) {
+            throw std::runtime_error("DepthExportSystem needs at least one view");
+        }
+
+        createDescriptorSetLayout();
+        createPipelineLayout();
+        createPipeline();
+
+        const uint32_t setCount = SwapChain::MAX_FRAMES_IN_FLIGHT * viewCount;
+        descriptorPool = DescriptorPool::Builder(device)
+            .setMaxSets(setCount)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount)
+            .build();
+
+        descriptorSets.resize(setCount, VK_NULL_HANDLE);
+        for (auto& set : descriptorSets) {
+            if (!descriptorPool->allocateDescriptor(depthSetLayout->getDescriptorSetLayout(), set))
+                throw std::runtime_error("failed to allocate depth export descriptor set");
+        }
+    }
+
+    DepthExportSystem::~DepthExportSystem() {
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+    }
+
+    void DepthExportSystem::createDescriptorSetLayout() {
+        depthSetLayout = DescriptorSetLayout::Builder(device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)  // scene depth
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)          // packed output
+            .build();
+    }
+
+    void DepthExportSystem::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(DepthPushConstant);
+
+        VkDescriptorSetLayout setLayout = depthSetLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        info.setLayoutCount = 1;
+        info.pSetLayouts = &setLayout;
+        info.pushConstantRangeCount = 1;
+        info.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device.device(), &info, nullptr, &pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create depth export pipeline layout");
+    }
+
+    void DepthExportSystem::createPipeline() {
+
+        auto code = Pipeline::readFile("../shaders/depth_export.comp.spv");
+        VkShaderModule shaderModule = Pipeline::createShaderModule(device.device(), code);
+
+        VkPipelineShaderStageCreateInfo stage{};
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage.module = shaderModule;
+        stage.pName = "main";
+
+        VkComputePipelineCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage = stage;
+        info.layout = pipelineLayout;
+
+        if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create depth export pipeline");
+
+        vkDestroyShaderModule(device.device(), shaderModule, nullptr);
+    }
+
+    VkDeviceSize DepthExportSystem::bufferSize(VkExtent2D extent) const {
+        const VkDeviceSize bytes = static_cast<VkDeviceSize>(rowStep(extent.width)) * extent.height;
+        return (bytes + 3) & ~VkDeviceSize{ 3 };
+    }
+
+    void DepthExportSystem::record(
+        VkCommandBuffer cmd,
+        int frameIndex,
+        uint32_t viewIndex,
+        VkImageView depthView,
+        VkSampler depthSampler,
+        float nearPlane,
+        float farPlane,
+        VkExtent2D extent,
+        VkBuffer dstBuffer) {
+
+        VkDescriptorSet& set = descriptorSets[static_cast<size_t>(frameIndex) * viewCount + viewIndex];
+
+        VkDescriptorImageInfo depthInfo{};
+        depthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        depthInfo.imageView = depthView;
+        depthInfo.sampler = depthSampler;
+
+        VkDescriptorBufferInfo dstInfo{};
+        dstInfo.buffer = dstBuffer;
+        dstInfo.offset = 0;
+        dstInfo.range = bufferSize(extent);
+
+        DescriptorWriter(*depthSetLayout, *descriptorPool)
+            .writeImage(0, &depthInfo)
+            .writeBuffer(1, &dstInfo)
+            .overwrite(set);
+
+        // the scene pass only makes its depth writes visible to fragment
+        // shaders
+        VkMemoryBarrier depthBarrier{};
+        depthBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &depthBarrier,
+            0, nullptr,
+            0, nullptr);
+
+        DepthPushConstant push{};
+        push.width = extent.width;
+        push.height = extent.height;
+        push.encoding = static_cast<uint32_t>(encoding);
+        push.wordCount = static_cast<uint32_t>(bufferSize(extent) / 4);
+        push.nearPlane = nearPlane;
+        push.farPlane = farPlane;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipelineLayout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+            0, sizeof(DepthPushConstant), &push);
+
+        vkCmdDispatch(cmd, (push.wordCount + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = dstBuffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &toHost, 0, nullptr);
+    }
+
+}
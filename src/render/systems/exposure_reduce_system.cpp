@@ -5,32 +5,6 @@
 
 namespace enginev {
 
-     static std::vector<char> readFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
-        if (!file.is_open())
-            throw std::runtime_error("failed to open file: " + filename);
-
-        size_t size = (size_t)file.tellg();
-        std::vector<char> buffer(size);
-        file.seekg(0);
-        file.read(buffer.data(), size);
-        file.close();
-        return buffer;
-    }
-
-    static VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code) {
-        VkShaderModuleCreateInfo info{};
-        info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        info.codeSize = code.size();
-        info.pCode    = reinterpret_cast<const uint32_t*>(code.data());
-
-        VkShaderModule module;
-        if (vkCreateShaderModule(device, &info, nullptr, &module) != VK_SUCCESS)
-            throw std::runtime_error("failed to create shader module");
-
-        return module;
-    }
-
     ExposureReduceSystem::ExposureReduceSystem(Device& device)
         : device(device)
     {
@@ -81,8 +55,8 @@ namespace enginev {
 
     void ExposureReduceSystem::createPipeline() {
 
-        auto code = readFile("../shaders/exposure_reduce.comp.spv");
-        VkShaderModule shaderModule = createShaderModule(device.device(), code);
+        auto code = Pipeline::readFile("../shaders/exposure_reduce.comp.spv");
+        VkShaderModule shaderModule = Pipeline::createShaderModule(device.device(), code);
 
         VkPipelineShaderStageCreateInfo stage{};
         stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -0,0 +1,340 @@
+#include "gpu_cull_system.hpp"
+#include "cpu_tracer.hpp"
+#include "pipeline.hpp"
+#include "swap_chain.hpp"
+#include "model.hpp"
+
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t MIN_OBJECT_CAPACITY = 1024;
+        constexpr uint32_t MIN_MODEL_CAPACITY = 64;
+        constexpr uint32_t LOCAL_SIZE = 64;
+        constexpr uint32_t NO_MODEL_INDEX = UINT32_MAX;
+
+        // std430 layout of ObjectData in cull.comp
+        struct GpuObjectData {
+            glm::mat4 modelMatrix{ 1.f };
+            glm::mat4 normalMatrix{ 1.f };
+            glm::vec4 sphere{ 0.f };
+            uint32_t modelIndex = NO_MODEL_INDEX;
+            uint32_t instanceBase = 0;
+            uint32_t pad0 = 0;
+            uint32_t pad1 = 0;
+        };
+        static_assert(sizeof(GpuObjectData) == 160, "GpuObjectData size must match cull.comp");
+        static_assert(sizeof(VkDrawIndexedIndirectCommand) == 20, "DrawCommand size must match cull.comp");
+
+        struct CullPushConstant {
+            uint32_t objectCount = 0;
+        };
+
+        uint32_t grow(uint32_t capacity, size_t required) {
+            while (capacity < required) {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+    }
+
+    GpuCullSystem::GpuCullSystem(Device& device, VkDescriptorSetLayout globalSetLayout, uint32_t viewCount)
+        : device(device), frames(SwapChain::MAX_FRAMES_IN_FLIGHT), lastVisibleCounts(viewCount, 0),
+          lastTestedCounts(viewCount, 0)
+    {
+        if (viewCount == 0) {
+            throw std::runtime_error("GpuCullSystem needs at least one view");
+        }
+
+        createDescriptorSetLayout();
+        createPipelineLayout(globalSetLayout);
+        createPipeline();
+
+        const uint32_t setCount = SwapChain::MAX_FRAMES_IN_FLIGHT * viewCount;
+        descriptorPool = DescriptorPool::Builder(device)
+            .setMaxSets(setCount)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount * 3)
+            .build();
+
+        for (auto& frame : frames) {
+            frame.views.resize(viewCount);
+            ensureCapacity(frame, MIN_OBJECT_CAPACITY, MIN_MODEL_CAPACITY);
+        }
+    }
+
+    GpuCullSystem::~GpuCullSystem() {
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+    }
+
+    void GpuCullSystem::createDescriptorSetLayout() {
+        cullSetLayout = DescriptorSetLayout::Builder(device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)  // objects
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)  // draw commands
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)  // instances
+            .build();
+    }
+
+    void GpuCullSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(CullPushConstant);
+
+        std::array<VkDescriptorSetLayout, 2> setLayouts = {
+            globalSetLayout, cullSetLayout->getDescriptorSetLayout()
+        };
+
+        VkPipelineLayoutCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        info.setLayoutCount = (uint32_t)setLayouts.size();
+        info.pSetLayouts = setLayouts.data();
+        info.pushConstantRangeCount = 1;
+        info.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device.device(), &info, nullptr, &pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create cull pipeline layout");
+    }
+
+    void GpuCullSystem::createPipeline() {
+
+        auto code = Pipeline::readFile("../shaders/cull.comp.spv");
+        VkShaderModule shaderModule = Pipeline::createShaderModule(device.device(), code);
+
+        VkPipelineShaderStageCreateInfo stage{};
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage.module = shaderModule;
+        stage.pName = "main";
+
+        VkComputePipelineCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage = stage;
+        info.layout = pipelineLayout;
+
+        if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create cull pipeline");
+
+        vkDestroyShaderModule(device.device(), shaderModule, nullptr);
+    }
+
+    void GpuCullSystem::ensureCapacity(FrameResources& frame, size_t objectCount, size_t modelCount) {
+        if (!frame.objects || frame.objects->getInstanceCount() < objectCount) {
+            const uint32_t capacity = grow(
+                frame.objects ? frame.objects->getInstanceCount() : MIN_OBJECT_CAPACITY, objectCount);
+
+            frame.objects = std::make_unique<Buffer>(
+                device,
+                sizeof(GpuObjectData),
+                capacity,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            frame.objects->map();
+
+            for (auto& view : frame.views) {
+                view.instances = std::make_unique<Buffer>(
+                    device,
+                    sizeof(Model::InstanceData),
+                    capacity,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+                view.descriptorsDirty = true;
+            }
+
+            frame.fullUpload = true;
+        }
+
+        for (auto& view : frame.views) {
+            if (!view.drawCommands || view.drawCommands->getInstanceCount() < modelCount) {
+                const uint32_t capacity = grow(
+                    view.drawCommands ? view.drawCommands->getInstanceCount() : MIN_MODEL_CAPACITY, modelCount);
+
+                view.drawCommands = std::make_unique<Buffer>(
+                    device,
+                    sizeof(VkDrawIndexedIndirectCommand),
+                    capacity,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+                view.drawCommands->map();
+
+                view.descriptorsDirty = true;
+                view.countsValid = false;
+            }
+
+            updateDescriptors(frame, view);
+        }
+    }
+
+    void GpuCullSystem::updateDescriptors(FrameResources& frame, ViewResources& view) {
+        if (!view.descriptorsDirty) {
+            return;
+        }
+
+        auto objectsInfo = frame.objects->descriptorInfo();
+        auto drawsInfo = view.drawCommands->descriptorInfo();
+        auto instancesInfo = view.instances->descriptorInfo();
+
+        DescriptorWriter writer(*cullSetLayout, *descriptorPool);
+        writer.writeBuffer(0, &objectsInfo)
+            .writeBuffer(1, &drawsInfo)
+            .writeBuffer(2, &instancesInfo);
+
+        if (view.descriptorSet == VK_NULL_HANDLE) {
+            if (!writer.build(view.descriptorSet))
+                throw std::runtime_error("failed to allocate cull descriptor set");
+        } else {
+            writer.overwrite(view.descriptorSet);
+        }
+        view.descriptorsDirty = false;
+    }
+
+    void GpuCullSystem::rebuildDraws(const SceneStore& scene) {
+        const auto& modelHandles = scene.getModelHandles();
+        const size_t modelCount = scene.modelCount();
+
+        // every model gets a contiguous instance range large enough for all
+        // of its objects, so the shader never has to compact across models
+        std::vector<uint32_t> counts(modelCount, 0);
+        for (uint32_t handle : modelHandles) {
+            if (handle != SceneStore::NO_MODEL) {
+                ++counts[handle];
+            }
+        }
+
+        draws.clear();
+        instanceBaseOfModel.assign(modelCount, 0);
+        commandTemplate.resize(modelCount);
+
+        uint32_t running = 0;
+        for (uint32_t handle = 0; handle < modelCount; ++handle) {
+            instanceBaseOfModel[handle] = running;
+            commandTemplate[handle] = scene.getModel(handle)->getIndirectCommand();
+            if (counts[handle] > 0) {
+                draws.push_back({ handle, running });
+                running += counts[handle];
+            }
+        }
+
+        drawsVersion = scene.getStructureVersion();
+        drawsBuilt = true;
+    }
+
+    void GpuCullSystem::writeObject(FrameResources& frame, const SceneStore& scene, uint32_t slot) {
+        auto* objects = static_cast<GpuObjectData*>(frame.objects->getMappedMemory());
+        const uint32_t handle = scene.getModelHandles()[slot];
+        const TransformComponent& transform = scene.getTransforms()[slot];
+
+        GpuObjectData& dst = objects[slot];
+        dst.modelMatrix = transform.worldMatrix;
+        dst.normalMatrix = transform.worldNormalMatrix;
+        // the label rides along in the unused corner of the normal matrix
+        dst.normalMatrix[3][3] = static_cast<float>(scene.objectLabel(slot));
+        dst.sphere = scene.getBounds()[slot];
+        dst.modelIndex = handle == SceneStore::NO_MODEL ? NO_MODEL_INDEX : handle;
+        dst.instanceBase = handle == SceneStore::NO_MODEL ? 0 : instanceBaseOfModel[handle];
+    }
+
+    void GpuCullSystem::update(int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& changedSlots) {
+        CpuTracer::Scope trace{ "GpuCullSystem::update" };
+        const size_t objectCount = scene.objectCount();
+
+        if (!drawsBuilt || drawsVersion != scene.getStructureVersion()) {
+            rebuildDraws(scene);
+            for (auto& frame : frames) {
+                frame.fullUpload = true;
+                frame.pendingSlots.clear();
+            }
+        } else if (!changedSlots.empty()) {
+            // every frame in flight has its own copy of the object buffer
+            for (auto& frame : frames) {
+                if (frame.fullUpload) continue;
+                if (frame.pendingSlots.size() + changedSlots.size() > objectCount) {
+                    frame.fullUpload = true;
+                    frame.pendingSlots.clear();
+                } else {
+                    frame.pendingSlots.insert(
+                        frame.pendingSlots.end(), changedSlots.begin(), changedSlots.end());
+                }
+            }
+        }
+
+        FrameResources& frame = frames[frameIndex];
+        ensureCapacity(frame, objectCount, scene.modelCount());
+
+        if (frame.fullUpload) {
+            for (uint32_t slot = 0; slot < objectCount; ++slot) {
+                writeObject(frame, scene, slot);
+            }
+            frame.fullUpload = false;
+        } else {
+            for (uint32_t slot : frame.pendingSlots) {
+                writeObject(frame, scene, slot);
+            }
+        }
+        frame.pendingSlots.clear();
+    }
+
+    void GpuCullSystem::cull(FrameInfo& frameInfo) {
+        CpuTracer::Scope trace{ "GpuCullSystem::cull", frameInfo.viewIndex };
+        if (draws.empty()) {
+            return;
+        }
+
+        const size_t objectCount = frameInfo.scene.objectCount();
+        ViewResources& view = frames[frameInfo.frameIndex].views[frameInfo.viewIndex];
+
+        // the frame that last used these commands has completed
+        auto* commands = static_cast<const VkDrawIndexedIndirectCommand*>(view.drawCommands->getMappedMemory());
+        if (view.countsValid) {
+            uint32_t visible = 0;
+            for (const auto& draw : draws) {
+                visible += commands[draw.modelHandle].instanceCount;
+            }
+            lastVisibleCounts[frameInfo.viewIndex] = visible;
+            lastTestedCounts[frameInfo.viewIndex] = view.testedCount;
+        }
+        view.countsValid = true;
+        view.testedCount = static_cast<uint32_t>(objectCount);
+
+        // reset the instance counts of this view
+        std::memcpy(
+            view.drawCommands->getMappedMemory(),
+            commandTemplate.data(),
+            commandTemplate.size() * sizeof(VkDrawIndexedIndirectCommand));
+
+        VkCommandBuffer cmd = frameInfo.commandBuffer;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+        std::array<VkDescriptorSet, 2> sets = { frameInfo.globalDescriptorSet, view.descriptorSet };
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipelineLayout, 0, (uint32_t)sets.size(), sets.data(), 0, nullptr);
+
+        CullPushConstant push{};
+        push.objectCount = static_cast<uint32_t>(objectCount);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+
+        vkCmdDispatch(cmd, (push.objectCount + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        // host: the visible counts read back by the next cull() of this view
+        barrier.dstAccessMask =
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+}
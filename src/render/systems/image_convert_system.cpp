@@ -0,0 +1,237 @@
+#include "image_convert_system.hpp"
+#include "pipeline.hpp"
+#include "swap_chain.hpp"
+
+#include <vulkan/vulkan.h>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t LOCAL_SIZE = 64;
+
+        struct ConvertPushConstant {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t encoding = 0;
+            uint32_t wordCount = 0;
+        };
+    }
+
+    bool ImageConvertSystem::parseEncoding(const std::string& name, ImageEncoding& encoding) {
+        for (ImageEncoding e : { ImageEncoding::BGRA8, ImageEncoding::RGB8, ImageEncoding::MONO8, ImageEncoding::YUV422 }) {
+            if (name == encodingName(e)) {
+                encoding = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* ImageConvertSystem::encodingName(ImageEncoding encoding) {
+        switch (encoding) {
+        case ImageEncoding::BGRA8: return "bgra8";
+        case ImageEncoding::RGB8: return "rgb8";
+        case ImageEncoding::MONO8: return "mono8";
+        case ImageEncoding::YUV422: return "yuv422";
+        }
+        return "bgra8";
+    }
+
+    uint32_t ImageConvertSystem::bytesPerPixel(ImageEncoding encoding) {
+        switch (encoding) {
+        case ImageEncoding::BGRA8: return 4;
+        case ImageEncoding::RGB8: return 3;
+        case ImageEncoding::MONO8: return 1;
+        case ImageEncoding::YUV422: return 2;
+        }
+        return 4;
+    }
+
+    ImageConvertSystem::ImageConvertSystem(Device& device, ImageEncoding encoding, uint32_t viewCount)
+        : device(device), encoding(encoding), viewCount(viewCount)
+    {
+        if (viewCount == 0) {
+            throw std::runtime_error("ImageConvertSystem needs at least one view");
+        }
+
+        createSampler();
+        createDescriptorSetLayout();
+        createPipelineLayout();
+        createPipeline();
+
+        const uint32_t setCount = SwapChain::MAX_FRAMES_IN_FLIGHT * viewCount;
+        descriptorPool = DescriptorPool::Builder(device)
+            .setMaxSets(setCount)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount)
+            .build();
+
+        descriptorSets.resize(setCount, VK_NULL_HANDLE);
+        for (auto& set : descriptorSets) {
+            if (!descriptorPool->allocateDescriptor(convertSetLayout->getDescriptorSetLayout(), set))
+                throw std::runtime_error("failed to allocate image convert descriptor set");
+        }
+    }
+
+    ImageConvertSystem::~ImageConvertSystem() {
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+        vkDestroySampler(device.device(), sampler, nullptr);
+    }
+
+    void ImageConvertSystem::createSampler() {
+        VkSamplerCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        info.magFilter = VK_FILTER_LINEAR;
+        info.minFilter = VK_FILTER_LINEAR;
+        info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.maxLod = 0.0f;
+
+        if (vkCreateSampler(device.device(), &info, nullptr, &sampler) != VK_SUCCESS)
+            throw std::runtime_error("failed to create image convert sampler");
+    }
+
+    void ImageConvertSystem::createDescriptorSetLayout() {
+        convertSetLayout = DescriptorSetLayout::Builder(device)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)  // rendered image
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)          // packed output
+            .build();
+    }
+
+    void ImageConvertSystem::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ConvertPushConstant);
+
+        VkDescriptorSetLayout setLayout = convertSetLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        info.setLayoutCount = 1;
+        info.pSetLayouts = &setLayout;
+        info.pushConstantRangeCount = 1;
+        info.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device.device(), &info, nullptr, &pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create image convert pipeline layout");
+    }
+
+    void ImageConvertSystem::createPipeline() {
+
+        auto code = Pipeline::readFile("../shaders/image_convert.comp.spv");
+        VkShaderModule shaderModule = Pipeline::createShaderModule(device.device(), code);
+
+        VkPipelineShaderStageCreateInfo stage{};
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage.module = shaderModule;
+        stage.pName = "main";
+
+        VkComputePipelineCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage = stage;
+        info.layout = pipelineLayout;
+
+        if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create image convert pipeline");
+
+        vkDestroyShaderModule(device.device(), shaderModule, nullptr);
+    }
+
+    VkExtent2D ImageConvertSystem::fitExtent(VkExtent2D extent) const {
+        if (encoding == ImageEncoding::YUV422) {
+            extent.width = extent.width & ~1u;
+        }
+        return extent;
+    }
+
+    VkDeviceSize ImageConvertSystem::bufferSize(VkExtent2D extent) const {
+        const VkDeviceSize bytes = static_cast<VkDeviceSize>(rowStep(extent.width)) * extent.height;
+        return (bytes + 3) & ~VkDeviceSize{ 3 };
+    }
+
+    void ImageConvertSystem::convert(
+        VkCommandBuffer cmd,
+        int frameIndex,
+        uint32_t viewIndex,
+        VkImage srcImage,
+        VkImageView srcView,
+        VkExtent2D extent,
+        VkBuffer dstBuffer) {
+
+        VkDescriptorSet& set = descriptorSets[static_cast<size_t>(frameIndex) * viewCount + viewIndex];
+
+        VkDescriptorImageInfo srcInfo{};
+        srcInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        srcInfo.imageView = srcView;
+        srcInfo.sampler = sampler;
+
+        VkDescriptorBufferInfo dstInfo{};
+        dstInfo.buffer = dstBuffer;
+        dstInfo.offset = 0;
+        dstInfo.range = bufferSize(extent);
+
+        DescriptorWriter(*convertSetLayout, *descriptorPool)
+            .writeImage(0, &srcInfo)
+            .writeBuffer(1, &dstInfo)
+            .overwrite(set);
+
+        // chains on the render pass's external dependency, which ends at the
+        // transfer stage and has already made the color writes available
+        VkImageMemoryBarrier toRead{};
+        toRead.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toRead.srcAccessMask = 0;
+        toRead.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toRead.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toRead.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toRead.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toRead.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toRead.image = srcImage;
+        toRead.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            1, &toRead);
+
+        ConvertPushConstant push{};
+        push.width = extent.width;
+        push.height = extent.height;
+        push.encoding = static_cast<uint32_t>(encoding);
+        push.wordCount = static_cast<uint32_t>(bufferSize(extent) / 4);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipelineLayout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+            0, sizeof(ConvertPushConstant), &push);
+
+        vkCmdDispatch(cmd, (push.wordCount + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = dstBuffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &toHost, 0, nullptr);
+    }
+
+}
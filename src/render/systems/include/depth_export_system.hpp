@@ -0,0 +1,77 @@
+#pragma once
+
+#include "device.hpp"
+#include "descriptors.hpp"
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace enginev {
+
+    // Encodings of the published depth images, named as in sensor_msgs.
+    // Values are passed to depth_export.comp.
+    enum class DepthEncoding : uint32_t {
+        FLOAT32 = 0,  // 32FC1, metres, +inf where nothing was hit
+        UINT16 = 1,   // 16UC1, millimetres, 0 where nothing was hit or out of range
+    };
+
+    // Depth sensor output from the frame that was just rendered. A compute
+    // pass reads the ScenePass depth target, turns it back into distance
+    // along the camera axis using the near/far planes of the projection and
+    // writes it straight into the readback buffer, resampled (nearest) to
+    // the size of the published color image so both stay registered.
+    class DepthExportSystem {
+    public:
+        DepthExportSystem(Device& device, DepthEncoding encoding, uint32_t viewCount = 1);
+        ~DepthExportSystem();
+
+        DepthExportSystem(const DepthExportSystem&) = delete;
+        DepthExportSystem& operator=(const DepthExportSystem&) = delete;
+
+        static bool parseEncoding(const std::string& name, DepthEncoding& encoding);
+        static const char* encodingName(DepthEncoding encoding);
+        static uint32_t bytesPerPixel(DepthEncoding encoding);
+
+        DepthEncoding getEncoding() const { return encoding; }
+
+        uint32_t rowStep(uint32_t width) const { return width * bytesPerPixel(encoding); }
+        // The shader writes whole 32-bit words.
+        VkDeviceSize bufferSize(VkExtent2D extent) const;
+
+        // Records the export of the depth target (in DEPTH_STENCIL_READ_ONLY
+        // layout after ScenePass::end) into dstBuffer, which needs
+        // STORAGE_BUFFER usage, followed by a barrier for host reads.
+        // Record outside of a render pass.
+        void record(
+            VkCommandBuffer cmd,
+            int frameIndex,
+            uint32_t viewIndex,
+            VkImageView depthView,
+            VkSampler depthSampler,
+            float nearPlane,
+            float farPlane,
+            VkExtent2D extent,
+            VkBuffer dstBuffer);
+
+    private:
+        void createDescriptorSetLayout();
+        void createPipelineLayout();
+        void createPipeline();
+
+        Device& device;
+        DepthEncoding encoding;
+        uint32_t viewCount;
+
+        VkPipelineLayout pipelineLayout{};
+        VkPipeline pipeline{};
+
+        std::unique_ptr<DescriptorSetLayout> depthSetLayout;
+        std::unique_ptr<DescriptorPool> descriptorPool;
+        // one set per frame in flight and view, rewritten every frame with
+        // that frame's readback buffer
+        std::vector<VkDescriptorSet> descriptorSets;
+    };
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+#include "descriptors.hpp"
+#include "frame_info.hpp"
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+
+namespace enginev {
+
+    // GPU-driven frustum culling. Object bounds and matrices live in a
+    // storage buffer mirrored from the SceneStore; a compute pass tests every
+    // object against the frustum planes in GlobalUbo, appends the visible
+    // instances to a per-model range of the instance buffer and counts them
+    // in a VkDrawIndexedIndirectCommand per model. The scene pass then draws
+    // each model with vkCmdDrawIndexedIndirect without reading anything back.
+    // The object buffer is shared by all views of a frame; every view has
+    // its own draw commands and instance buffer.
+    class GpuCullSystem {
+    public:
+        // One indirect draw, the command lives at
+        // modelHandle * sizeof(VkDrawIndexedIndirectCommand).
+        struct Draw {
+            uint32_t modelHandle;
+            uint32_t instanceBase;
+        };
+
+        GpuCullSystem(Device& device, VkDescriptorSetLayout globalSetLayout, uint32_t viewCount = 1);
+        ~GpuCullSystem();
+
+        GpuCullSystem(const GpuCullSystem&) = delete;
+        GpuCullSystem& operator=(const GpuCullSystem&) = delete;
+
+        // Uploads the changed object data of the frame, once per frame
+        // before the first cull().
+        void update(int frameIndex, const SceneStore& scene, const std::vector<uint32_t>& changedSlots);
+
+        // Records the culling dispatch for frameInfo.viewIndex followed by a
+        // barrier for indirect draws. Must be recorded outside of a render
+        // pass and after the view's GlobalUbo has been written.
+        void cull(FrameInfo& frameInfo);
+
+        const std::vector<Draw>& getDraws() const { return draws; }
+        // Instances that passed the test the last time this view's draw
+        // commands were read back, i.e. MAX_FRAMES_IN_FLIGHT frames ago
+        // (counted in cull(), once the GPU is done with them).
+        uint32_t getLastVisibleCount(uint32_t viewIndex = 0) const { return lastVisibleCounts[viewIndex]; }
+        // Objects that same cull was run on.
+        uint32_t getLastTestedCount(uint32_t viewIndex = 0) const { return lastTestedCounts[viewIndex]; }
+        VkBuffer getDrawCommandBuffer(int frameIndex, uint32_t viewIndex = 0) const {
+            return frames[frameIndex].views[viewIndex].drawCommands->getBuffer();
+        }
+        VkBuffer getInstanceBuffer(int frameIndex, uint32_t viewIndex = 0) const {
+            return frames[frameIndex].views[viewIndex].instances->getBuffer();
+        }
+
+    private:
+        struct ViewResources {
+            std::unique_ptr<Buffer> drawCommands;
+            std::unique_ptr<Buffer> instances;
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+            bool descriptorsDirty = true;
+            bool countsValid = false;  // drawCommands hold a finished cull
+            uint32_t testedCount = 0;  // objects that cull was run on
+        };
+
+        struct FrameResources {
+            std::unique_ptr<Buffer> objects;
+            std::vector<ViewResources> views;
+            std::vector<uint32_t> pendingSlots;
+            bool fullUpload = true;
+        };
+
+        void createDescriptorSetLayout();
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+        void createPipeline();
+
+        void rebuildDraws(const SceneStore& scene);
+        void ensureCapacity(FrameResources& frame, size_t objectCount, size_t modelCount);
+        void updateDescriptors(FrameResources& frame, ViewResources& view);
+        void writeObject(FrameResources& frame, const SceneStore& scene, uint32_t slot);
+
+        Device& device;
+
+        std::unique_ptr<DescriptorSetLayout> cullSetLayout;
+        std::unique_ptr<DescriptorPool> descriptorPool;
+        VkPipelineLayout pipelineLayout{};
+        VkPipeline pipeline{};
+
+        std::vector<FrameResources> frames;
+        std::vector<uint32_t> lastVisibleCounts;  // per view
+        std::vector<uint32_t> lastTestedCounts;   // per view
+
+        uint64_t drawsVersion = 0;
+        bool drawsBuilt = false;
+        std::vector<Draw> draws;
+        std::vector<uint32_t> instanceBaseOfModel;
+        std::vector<VkDrawIndexedIndirectCommand> commandTemplate;
+    };
+
+}
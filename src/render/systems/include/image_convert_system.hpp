@@ -0,0 +1,86 @@
+#pragma once
+
+#include "device.hpp"
+#include "descriptors.hpp"
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace enginev {
+
+    // Encodings of the published camera images, named as in sensor_msgs.
+    // Values are passed to image_convert.comp.
+    enum class ImageEncoding : uint32_t {
+        BGRA8 = 0,
+        RGB8 = 1,
+        MONO8 = 2,
+        YUV422 = 3,  // UYVY
+    };
+
+    // Packs a rendered frame into a ROS image on the GPU, so only the bytes
+    // that get published are read back. A compute pass samples the final
+    // post-processed image bilinearly (the output may have a different size
+    // than the render target), re-encodes it to sRGB and writes unpadded
+    // rows of the requested encoding straight into the readback buffer.
+    // Compared with bgra8, rgb8 reads back 3/4 of the bytes, yuv422 1/2 and
+    // mono8 1/4.
+    class ImageConvertSystem {
+    public:
+        ImageConvertSystem(Device& device, ImageEncoding encoding, uint32_t viewCount = 1);
+        ~ImageConvertSystem();
+
+        ImageConvertSystem(const ImageConvertSystem&) = delete;
+        ImageConvertSystem& operator=(const ImageConvertSystem&) = delete;
+
+        static bool parseEncoding(const std::string& name, ImageEncoding& encoding);
+        static const char* encodingName(ImageEncoding encoding);
+        static uint32_t bytesPerPixel(ImageEncoding encoding);
+
+        ImageEncoding getEncoding() const { return encoding; }
+
+        // yuv422 shares chroma between pixel pairs, so its width is rounded
+        // down to an even number.
+        VkExtent2D fitExtent(VkExtent2D extent) const;
+        uint32_t rowStep(uint32_t width) const { return width * bytesPerPixel(encoding); }
+        // The shader writes whole 32-bit words, so the destination buffer
+        // may need up to 3 bytes more than rowStep * height.
+        VkDeviceSize bufferSize(VkExtent2D extent) const;
+
+        // Records the conversion of srcImage into dstBuffer (which needs
+        // STORAGE_BUFFER usage), followed by a barrier for host reads.
+        // srcImage must have just been rendered by a render pass that leaves
+        // it in TRANSFER_SRC_OPTIMAL. Record outside of a render pass;
+        // extent must be a fitExtent() result.
+        void convert(
+            VkCommandBuffer cmd,
+            int frameIndex,
+            uint32_t viewIndex,
+            VkImage srcImage,
+            VkImageView srcView,
+            VkExtent2D extent,
+            VkBuffer dstBuffer);
+
+    private:
+        void createSampler();
+        void createDescriptorSetLayout();
+        void createPipelineLayout();
+        void createPipeline();
+
+        Device& device;
+        ImageEncoding encoding;
+        uint32_t viewCount;
+
+        VkSampler sampler{};
+        VkPipelineLayout pipelineLayout{};
+        VkPipeline pipeline{};
+
+        std::unique_ptr<DescriptorSetLayout> convertSetLayout;
+        std::unique_ptr<DescriptorPool> descriptorPool;
+        // one set per frame in flight and view, rewritten every frame with
+        // that frame's source image and readback buffer
+        std::vector<VkDescriptorSet> descriptorSets;
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+#include "frame_info.hpp"
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+
+namespace enginev {
+
+    // Clustered forward lighting. A compute pass bins the point lights into
+    // a CLUSTER_X x CLUSTER_Y x CLUSTER_Z view-space grid (exponential depth
+    // slices between the camera planes in GlobalUbo::clusterParams), writing
+    // a light count (global set, binding 4) and up to MAX_LIGHTS_PER_CLUSTER
+    // light indices (binding 5) per cluster. shader_clustered.frag then only
+    // evaluates the lights of the fragment's cluster. The grid depends on
+    // the camera, so every view has its own cluster buffers.
+    class LightClusterSystem {
+    public:
+        static constexpr uint32_t CLUSTER_X = 16;
+        static constexpr uint32_t CLUSTER_Y = 9;
+        static constexpr uint32_t CLUSTER_Z = 24;
+        static constexpr uint32_t CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+        static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+
+        LightClusterSystem(Device& device, VkDescriptorSetLayout globalSetLayout, uint32_t viewCount = 1);
+        ~LightClusterSystem();
+
+        LightClusterSystem(const LightClusterSystem&) = delete;
+        LightClusterSystem& operator=(const LightClusterSystem&) = delete;
+
+        // Clears the counts and records the binning dispatch followed by a
+        // barrier for fragment shader reads. Must be recorded outside of a
+        // render pass after the view's GlobalUbo and the lights are written.
+        void dispatch(FrameInfo& frameInfo, uint32_t lightCount);
+
+        VkDescriptorBufferInfo countsInfo(int frameIndex, uint32_t viewIndex = 0) const {
+            return counts[bufferIndex(frameIndex, viewIndex)]->descriptorInfo();
+        }
+        VkDescriptorBufferInfo lightIndicesInfo(int frameIndex, uint32_t viewIndex = 0) const {
+            return lightIndices[bufferIndex(frameIndex, viewIndex)]->descriptorInfo();
+        }
+
+    private:
+        size_t bufferIndex(int frameIndex, uint32_t viewIndex) const {
+            return static_cast<size_t>(frameIndex) * viewCount + viewIndex;
+        }
+
+        void createBuffers();
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+        void createPipeline();
+
+        Device& device;
+        uint32_t viewCount;
+
+        VkPipelineLayout pipelineLayout{};
+        VkPipeline pipeline{};
+
+        std::vector<std::unique_ptr<Buffer>> counts;
+        std::vector<std::unique_ptr<Buffer>> lightIndices;
+    };
+
+}
@@ -14,18 +14,18 @@ namespace enginev {
     class PointLightSystem {
     public:
         PointLightSystem(
-            Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+            Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+            bool labelAttachment = false);
         ~PointLightSystem();
 
         PointLightSystem(const PointLightSystem&) = delete;
         PointLightSystem& operator=(const PointLightSystem&) = delete;
 
-        void update(FrameInfo& frameInfo, GlobalUbo& ubo);
         void render(FrameInfo& frameInfo);
 
     private:
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
-        void createPipeline(VkRenderPass renderPass);
+        void createPipeline(VkRenderPass renderPass, bool labelAttachment);
 
         Device& device;
 
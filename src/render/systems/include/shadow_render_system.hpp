@@ -5,6 +5,7 @@
 #include "pipeline.hpp"
 #include "camera.hpp"
 #include "frame_info.hpp"
+#include "instance_batcher.hpp"
 
 // std
 #include <memory>
@@ -22,13 +23,27 @@ namespace enginev {
 
 		void renderSimObjects(FrameInfo& frameInfo);
 
+		// Instanced drawing (one draw per visible model) is the default;
+		// the per-object push constant path is kept for comparison.
+		void setInstancingEnabled(bool enabled) { instancingEnabled = enabled; }
+		uint32_t getLastDrawCount() const { return lastDrawCount; }
+
 	private:
 		void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
 		void createPipeline(VkRenderPass renderPass);
+		void renderInstanced(FrameInfo& frameInfo);
+		void renderPerObject(FrameInfo& frameInfo);
 
 		Device& device;
 
 		std::unique_ptr<Pipeline> pipeline;
+		std::unique_ptr<Pipeline> instancedPipeline;
 		VkPipelineLayout pipelineLayout;
+
+		InstanceBatcher instanceBatcher;
+		bool instancingEnabled = true;
+		uint32_t lastDrawCount = 0;
+
+		std::vector<uint32_t> casterSlots;
 	};
 }
\ No newline at end of file
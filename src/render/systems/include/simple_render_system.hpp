@@ -5,6 +5,8 @@
 #include "pipeline.hpp"
 #include "camera.hpp"
 #include "frame_info.hpp"
+#include "instance_batcher.hpp"
+#include "gpu_cull_system.hpp"
 
 // std
 #include <memory>
@@ -14,7 +16,8 @@ namespace enginev {
 	class SimpleRenderSystem {
 	public:
 		SimpleRenderSystem(
-			Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+			Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+			bool labelAttachment = false);
 		~SimpleRenderSystem();
 
 		SimpleRenderSystem(const SimpleRenderSystem&) = delete;
@@ -22,13 +25,46 @@ namespace enginev {
 
 		void renderSimObjects(FrameInfo& frameInfo);
 
+		// Instanced drawing (one draw per visible model) is the default;
+		// the per-object push constant path is kept for comparison.
+		void setInstancingEnabled(bool enabled) { instancingEnabled = enabled; }
+		// When set, objects are culled on the GPU by gpuCullSystem (which must
+		// have run for the frame) and drawn with indirect draws.
+		void setGpuCullSystem(GpuCullSystem* system) { gpuCullSystem = system; }
+		// Shades with shader_clustered.frag, which needs LightClusterSystem to
+		// have binned the lights for the frame.
+		void setClusteredLighting(bool enabled) { clusteredLighting = enabled; }
+		uint32_t getLastDrawCount() const { return lastDrawCount; }
+		// Objects that passed culling in the last renderSimObjects() call; with
+		// GPU culling the count of MAX_FRAMES_IN_FLIGHT frames earlier.
+		uint32_t getLastVisibleCount() const { return lastVisibleCount; }
+		// Objects the culling behind getLastVisibleCount() was run on.
+		uint32_t getLastTestedCount() const { return lastTestedCount; }
+
 	private:
 		void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
-		void createPipeline(VkRenderPass renderPass);
+		void createPipeline(VkRenderPass renderPass, bool labelAttachment);
+		void renderInstanced(FrameInfo& frameInfo);
+		void renderPerObject(FrameInfo& frameInfo);
+		void renderIndirect(FrameInfo& frameInfo);
+		void bindPipeline(FrameInfo& frameInfo, bool instanced);
 
 		Device& device;
 
 		std::unique_ptr<Pipeline> pipeline;
+		std::unique_ptr<Pipeline> instancedPipeline;
+		std::unique_ptr<Pipeline> clusteredPipeline;
+		std::unique_ptr<Pipeline> clusteredInstancedPipeline;
 		VkPipelineLayout pipelineLayout;
+
+		std::vector<std::unique_ptr<InstanceBatcher>> instanceBatchers;  // per view
+		GpuCullSystem* gpuCullSystem = nullptr;
+		bool instancingEnabled = true;
+		bool clusteredLighting = false;
+		uint32_t lastDrawCount = 0;
+		uint32_t lastVisibleCount = 0;
+		uint32_t lastTestedCount = 0;
+
+		std::vector<uint32_t> visibleSlots;
 	};
 }
\ No newline at end of file
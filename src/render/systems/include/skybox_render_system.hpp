@@ -11,8 +11,10 @@
 namespace enginev {
 	class SkyboxRenderSystem {
 	public:
+		// The cube model is queued on uploader, flush it before rendering.
 		SkyboxRenderSystem(
-			Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+			Device& device, UploadBatcher& uploader, VkRenderPass renderPass,
+			VkDescriptorSetLayout globalSetLayout, bool labelAttachment = false);
 		~SkyboxRenderSystem();
 
 		SkyboxRenderSystem(const SkyboxRenderSystem&) = delete;
@@ -22,7 +24,7 @@ namespace enginev {
 
 	private:
 		void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
-		void createPipeline(VkRenderPass renderPass);
+		void createPipeline(VkRenderPass renderPass, bool labelAttachment);
 
 		Device& device;
 
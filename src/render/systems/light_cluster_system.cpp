@@ -0,0 +1,133 @@
+#include "light_cluster_system.hpp"
+#include "cpu_tracer.hpp"
+#include "pipeline.hpp"
+#include "swap_chain.hpp"
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        constexpr uint32_t LOCAL_SIZE = 64;
+    }
+
+    LightClusterSystem::LightClusterSystem(Device& device, VkDescriptorSetLayout globalSetLayout, uint32_t viewCount)
+        : device(device), viewCount(viewCount)
+    {
+        if (viewCount == 0) {
+            throw std::runtime_error("LightClusterSystem needs at least one view");
+        }
+
+        createBuffers();
+        createPipelineLayout(globalSetLayout);
+        createPipeline();
+    }
+
+    LightClusterSystem::~LightClusterSystem() {
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+    }
+
+    void LightClusterSystem::createBuffers() {
+        // one copy per frame in flight and view, consecutive frames may
+        // overlap on the GPU
+        const size_t bufferCount = static_cast<size_t>(SwapChain::MAX_FRAMES_IN_FLIGHT) * viewCount;
+        counts.resize(bufferCount);
+        lightIndices.resize(bufferCount);
+
+        for (size_t i = 0; i < bufferCount; ++i) {
+            counts[i] = std::make_unique<Buffer>(
+                device,
+                sizeof(uint32_t),
+                CLUSTER_COUNT,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            lightIndices[i] = std::make_unique<Buffer>(
+                device,
+                sizeof(uint32_t),
+                CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+    }
+
+    void LightClusterSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+        VkPipelineLayoutCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        info.setLayoutCount = 1;
+        info.pSetLayouts = &globalSetLayout;
+
+        if (vkCreatePipelineLayout(device.device(), &info, nullptr, &pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create light cluster pipeline layout");
+    }
+
+    void LightClusterSystem::createPipeline() {
+
+        auto code = Pipeline::readFile("../shaders/light_cluster.comp.spv");
+        VkShaderModule shaderModule = Pipeline::createShaderModule(device.device(), code);
+
+        VkPipelineShaderStageCreateInfo stage{};
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage.module = shaderModule;
+        stage.pName = "main";
+
+        VkComputePipelineCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage = stage;
+        info.layout = pipelineLayout;
+
+        if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create light cluster pipeline");
+
+        vkDestroyShaderModule(device.device(), shaderModule, nullptr);
+    }
+
+    void LightClusterSystem::dispatch(FrameInfo& frameInfo, uint32_t lightCount) {
+        CpuTracer::Scope trace{ "LightClusterSystem::dispatch", frameInfo.viewIndex };
+        VkCommandBuffer cmd = frameInfo.commandBuffer;
+        VkBuffer countBuffer = counts[bufferIndex(frameInfo.frameIndex, frameInfo.viewIndex)]->getBuffer();
+
+        vkCmdFillBuffer(cmd, countBuffer, 0, VK_WHOLE_SIZE, 0);
+
+        VkMemoryBarrier clearBarrier{};
+        clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            1, &clearBarrier,
+            0, nullptr,
+            0, nullptr);
+
+        if (lightCount > 0) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
+
+            vkCmdDispatch(cmd, (lightCount + LOCAL_SIZE - 1) / LOCAL_SIZE, 1, 1);
+        }
+
+        VkMemoryBarrier binBarrier{};
+        binBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        binBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        binBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            1, &binBarrier,
+            0, nullptr,
+            0, nullptr);
+    }
+
+}
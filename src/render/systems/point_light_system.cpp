@@ -1,4 +1,5 @@
 #include "point_light_system.hpp"
+#include "cpu_tracer.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -10,7 +11,8 @@
 #include <array>
 #include <cassert>
 #include <stdexcept>
-#include <map>
+#include <algorithm>
+#include <utility>
 
 namespace enginev {
     
@@ -21,10 +23,11 @@ namespace enginev {
     };
 
     PointLightSystem::PointLightSystem(
-        Device& ldevice, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
+        Device& ldevice, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+        bool labelAttachment)
         : device{ ldevice } {
         createPipelineLayout(globalSetLayout);
-        createPipeline(renderPass);
+        createPipeline(renderPass, labelAttachment);
     }
 
     PointLightSystem::~PointLightSystem() {
@@ -51,7 +54,7 @@ namespace enginev {
         }
     }
 
-    void PointLightSystem::createPipeline(VkRenderPass renderPass) {
+    void PointLightSystem::createPipeline(VkRenderPass renderPass, bool labelAttachment) {
         assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
         PipelineConfigInfo pipelineConfig{};
@@ -61,6 +64,10 @@ namespace enginev {
         pipelineConfig.bindingDescriptions.clear();
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
+        if (labelAttachment) {
+            // drawn into the scene pass, but not an object
+            Pipeline::enableLabelAttachment(pipelineConfig, false);
+        }
         pipeline = std::make_unique<Pipeline>(
             device,
             "../shaders/point_light.vert.spv",
@@ -68,40 +75,25 @@ namespace enginev {
             pipelineConfig);
     }
 
-    void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
-
-        int lightIndex = 0;
-        for (auto& kv : frameInfo.simObjects) {
-            auto& obj = kv.second;
-            if (obj.pointLight == nullptr) continue;
-
-            assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specified");
-
-            // update light position
-           obj.transform.translation = glm::vec3(
-            //rotateLight * 
-            glm::vec4(obj.transform.translation, 1.f));
-
-            // copy light to ubo
-            ubo.pointLights[lightIndex].position = glm::vec4(obj.transform.translation, 1.f);
-            ubo.pointLights[lightIndex].color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
-
-            lightIndex += 1;
-        }
-        ubo.numLights = lightIndex;
-    }
     void PointLightSystem::render(FrameInfo& frameInfo) {
-
-        std::map<float, SimObject::id_t> sorted;
-        for (auto& kv : frameInfo.simObjects) {
-            auto& obj = kv.second;
-            if (obj.pointLight == nullptr) continue;
-
-            // calculate distance
-            auto offset = frameInfo.camera.getPosition() - obj.transform.translation;
-            float disSquared = glm::dot(offset, offset);
-            sorted[disSquared] = obj.getId();
+        CpuTracer::Scope trace{ "PointLightSystem::render", frameInfo.viewIndex };
+
+        const SceneStore& scene = frameInfo.scene;
+        const auto& positions = scene.getLightPositions();
+        const auto& colors = scene.getLightColors();
+
+        // (distance squared, light slot), drawn back to front
+        std::vector<std::pair<float, uint32_t>> sorted;
+        sorted.reserve(scene.lightCount());
+        const glm::vec3 cameraPos = frameInfo.camera.getPosition();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(scene.lightCount()); ++i) {
+            auto offset = cameraPos - glm::vec3(positions[i]);
+            sorted.emplace_back(glm::dot(offset, offset), i);
         }
+        std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+                return a.first > b.first;
+            });
 
         pipeline->bind(frameInfo.commandBuffer);
 
@@ -115,15 +107,13 @@ namespace enginev {
             0,
             nullptr);
 
-        // iterate through sorted lights in reverse order
-        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
-            // use game obj id to find light object
-            auto& obj = frameInfo.simObjects.at(it->second);
+        for (const auto& entry : sorted) {
+            const uint32_t slot = entry.second;
 
             PointLightPushConstants push{};
-            push.position = glm::vec4(obj.transform.translation, 1.f);
-            push.color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
-            push.radius = obj.transform.scale.x;
+            push.position = glm::vec4(glm::vec3(positions[slot]), 1.f);
+            push.color = colors[slot];
+            push.radius = positions[slot].w;
 
             vkCmdPushConstants(
                 frameInfo.commandBuffer,
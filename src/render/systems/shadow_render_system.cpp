@@ -1,4 +1,5 @@
 #include "shadow_render_system.hpp"
+#include "cpu_tracer.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -20,7 +21,7 @@ namespace enginev {
 
     ShadowRenderSystem::ShadowRenderSystem(
         Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
-        : device{ device } {
+        : device{ device }, instanceBatcher{ device } {
         createPipelineLayout(globalSetLayout);
         createPipeline(renderPass);
     }
@@ -77,10 +78,56 @@ namespace enginev {
             "../shaders/shadow.vert.spv",
             "../shaders/shadow.frag.spv",
             pipelineConfig);
+
+        Pipeline::enableInstancing(pipelineConfig);
+        instancedPipeline = std::make_unique<Pipeline>(
+            device,
+            "../shaders/shadow_instanced.vert.spv",
+            "../shaders/shadow.frag.spv",
+            pipelineConfig);
     }
 
     void ShadowRenderSystem::renderSimObjects(FrameInfo& frameInfo) {
-       
+        CpuTracer::Scope trace{ "ShadowRenderSystem::renderSimObjects" };
+        casterSlots.clear();
+        frameInfo.bvh.query(frameInfo.shadowFrustum, casterSlots);
+
+        if (instancingEnabled) {
+            renderInstanced(frameInfo);
+        } else {
+            renderPerObject(frameInfo);
+        }
+    }
+
+    void ShadowRenderSystem::renderInstanced(FrameInfo& frameInfo) {
+        const auto& batches = instanceBatcher.build(frameInfo.frameIndex, frameInfo.scene, casterSlots);
+
+        instancedPipeline->bind(frameInfo.commandBuffer);
+
+        vkCmdBindDescriptorSets(
+            frameInfo.commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipelineLayout,
+            0,
+            1,
+            &frameInfo.globalDescriptorSet,
+            0,
+            nullptr);
+
+        VkBuffer instanceBuffer = instanceBatcher.getBuffer(frameInfo.frameIndex);
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(
+            frameInfo.commandBuffer, Model::InstanceData::BINDING, 1, &instanceBuffer, &offset);
+
+        for (const auto& batch : batches) {
+            Model* model = frameInfo.scene.getModel(batch.modelHandle);
+            model->bind(frameInfo.commandBuffer);
+            model->drawInstanced(frameInfo.commandBuffer, batch.instanceCount, batch.firstInstance);
+        }
+        lastDrawCount = static_cast<uint32_t>(batches.size());
+    }
+
+    void ShadowRenderSystem::renderPerObject(FrameInfo& frameInfo) {
         pipeline->bind(frameInfo.commandBuffer);
 
         vkCmdBindDescriptorSets(
@@ -93,12 +140,17 @@ namespace enginev {
             0,
             nullptr);
 
-        for (auto& kv : frameInfo.simObjects) {
-            auto& obj = kv.second;
-            if (obj.model == nullptr) continue;
+        const SceneStore& scene = frameInfo.scene;
+        const auto& transforms = scene.getTransforms();
+        const auto& modelHandles = scene.getModelHandles();
+
+        uint32_t boundModel = SceneStore::NO_MODEL;
+        for (uint32_t i : casterSlots) {
+            const uint32_t handle = modelHandles[i];
+
             ShadowPushConstantData push{};
-            push.modelMatrix = obj.transform.mat4();
-            push.normalMatrix = obj.transform.normalMatrix();
+            push.modelMatrix = transforms[i].worldMatrix;
+            push.normalMatrix = transforms[i].worldNormalMatrix;
 
             vkCmdPushConstants(
                 frameInfo.commandBuffer,
@@ -107,9 +159,15 @@ namespace enginev {
                 0,
                 sizeof(ShadowPushConstantData),
                 &push);
-            obj.model->bind(frameInfo.commandBuffer);
-            obj.model->draw(frameInfo.commandBuffer);
+
+            Model* model = scene.getModel(handle);
+            if (handle != boundModel) {
+                model->bind(frameInfo.commandBuffer);
+                boundModel = handle;
+            }
+            model->draw(frameInfo.commandBuffer);
         }
+        lastDrawCount = static_cast<uint32_t>(casterSlots.size());
     }
 
 }
@@ -1,11 +1,11 @@
 #include "simple_render_system.hpp"
+#include "cpu_tracer.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
-#include <glm/gtx/component_wise.hpp>
 
 // std
 #include <array>
@@ -20,10 +20,11 @@ namespace enginev {
     };
 
     SimpleRenderSystem::SimpleRenderSystem(
-        Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
+        Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout,
+        bool labelAttachment)
         : device{ device } {
         createPipelineLayout(globalSetLayout);
-        createPipeline(renderPass);
+        createPipeline(renderPass, labelAttachment);
     }
 
     SimpleRenderSystem::~SimpleRenderSystem() {
@@ -50,7 +51,7 @@ namespace enginev {
         }
     }
 
-    void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
+    void SimpleRenderSystem::createPipeline(VkRenderPass renderPass, bool labelAttachment) {
         assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
         PipelineConfigInfo pipelineConfig{};
@@ -58,16 +59,48 @@ namespace enginev {
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
         pipelineConfig.rasterizationInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        if (labelAttachment) {
+            Pipeline::enableLabelAttachment(pipelineConfig, true);
+        }
         pipeline = std::make_unique<Pipeline>(
             device,
             "../shaders/shader.vert.spv",
             "../shaders/shader.frag.spv",
             pipelineConfig);
+
+        PipelineConfigInfo instancedConfig{};
+        Pipeline::defaultPipelineConfigInfo(instancedConfig);
+        Pipeline::enableInstancing(instancedConfig);
+        instancedConfig.renderPass = renderPass;
+        instancedConfig.pipelineLayout = pipelineLayout;
+        instancedConfig.rasterizationInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        if (labelAttachment) {
+            Pipeline::enableLabelAttachment(instancedConfig, true);
+        }
+        instancedPipeline = std::make_unique<Pipeline>(
+            device,
+            "../shaders/shader_instanced.vert.spv",
+            "../shaders/shader.frag.spv",
+            instancedConfig);
+
+        clusteredPipeline = std::make_unique<Pipeline>(
+            device,
+            "../shaders/shader.vert.spv",
+            "../shaders/shader_clustered.frag.spv",
+            pipelineConfig);
+        clusteredInstancedPipeline = std::make_unique<Pipeline>(
+            device,
+            "../shaders/shader_instanced.vert.spv",
+            "../shaders/shader_clustered.frag.spv",
+            instancedConfig);
     }
 
-    void SimpleRenderSystem::renderSimObjects(FrameInfo& frameInfo) {
-       
-        pipeline->bind(frameInfo.commandBuffer);
+    void SimpleRenderSystem::bindPipeline(FrameInfo& frameInfo, bool instanced) {
+        if (instanced) {
+            (clusteredLighting ? clusteredInstancedPipeline : instancedPipeline)->bind(frameInfo.commandBuffer);
+        } else {
+            (clusteredLighting ? clusteredPipeline : pipeline)->bind(frameInfo.commandBuffer);
+        }
 
         vkCmdBindDescriptorSets(
             frameInfo.commandBuffer,
@@ -78,23 +111,92 @@ namespace enginev {
             &frameInfo.globalDescriptorSet,
             0,
             nullptr);
+    }
+
+    void SimpleRenderSystem::renderSimObjects(FrameInfo& frameInfo) {
+        CpuTracer::Scope trace{ "SimpleRenderSystem::renderSimObjects", frameInfo.viewIndex };
+        if (gpuCullSystem) {
+            renderIndirect(frameInfo);
+            lastVisibleCount = gpuCullSystem->getLastVisibleCount(frameInfo.viewIndex);
+            lastTestedCount = gpuCullSystem->getLastTestedCount(frameInfo.viewIndex);
+            return;
+        }
+
+        visibleSlots.clear();
+        frameInfo.bvh.query(frameInfo.frustum, visibleSlots);
+        lastVisibleCount = static_cast<uint32_t>(visibleSlots.size());
+        lastTestedCount = static_cast<uint32_t>(frameInfo.scene.objectCount());
+
+        if (instancingEnabled) {
+            renderInstanced(frameInfo);
+        } else {
+            renderPerObject(frameInfo);
+        }
+    }
+
+    void SimpleRenderSystem::renderInstanced(FrameInfo& frameInfo) {
+        // views recorded into the same frame must not share instance data
+        while (instanceBatchers.size() <= frameInfo.viewIndex) {
+            instanceBatchers.push_back(std::make_unique<InstanceBatcher>(device));
+        }
+        InstanceBatcher& instanceBatcher = *instanceBatchers[frameInfo.viewIndex];
+
+        const auto& batches = instanceBatcher.build(frameInfo.frameIndex, frameInfo.scene, visibleSlots);
+
+        bindPipeline(frameInfo, true);
+
+        VkBuffer instanceBuffer = instanceBatcher.getBuffer(frameInfo.frameIndex);
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(
+            frameInfo.commandBuffer, Model::InstanceData::BINDING, 1, &instanceBuffer, &offset);
+
+        for (const auto& batch : batches) {
+            Model* model = frameInfo.scene.getModel(batch.modelHandle);
+            model->bind(frameInfo.commandBuffer);
+            model->drawInstanced(frameInfo.commandBuffer, batch.instanceCount, batch.firstInstance);
+        }
+        lastDrawCount = static_cast<uint32_t>(batches.size());
+    }
+
+    void SimpleRenderSystem::renderIndirect(FrameInfo& frameInfo) {
+        bindPipeline(frameInfo, true);
 
-        for (auto& kv : frameInfo.simObjects) {
-            auto& obj = kv.second;
-            if (obj.model == nullptr) continue;
+        VkBuffer instanceBuffer = gpuCullSystem->getInstanceBuffer(frameInfo.frameIndex, frameInfo.viewIndex);
+        VkBuffer commandBuffer = gpuCullSystem->getDrawCommandBuffer(frameInfo.frameIndex, frameInfo.viewIndex);
 
-            glm::vec3 worldPos = obj.transform.translation;
+        for (const auto& draw : gpuCullSystem->getDraws()) {
+            // the instance range is selected with the binding offset, so
+            // firstInstance stays 0 and drawIndirectFirstInstance is not needed
+            VkDeviceSize offset = sizeof(Model::InstanceData) * draw.instanceBase;
+            vkCmdBindVertexBuffers(
+                frameInfo.commandBuffer, Model::InstanceData::BINDING, 1, &instanceBuffer, &offset);
 
-            float scaledRadius =
-                obj.model->boundingRadius *
-                glm::compMax(obj.transform.scale);
-            
-            if (!isVisible(frameInfo.frustum, worldPos, scaledRadius))
-                continue;
+            Model* model = frameInfo.scene.getModel(draw.modelHandle);
+            model->bind(frameInfo.commandBuffer);
+            model->drawIndirect(
+                frameInfo.commandBuffer,
+                commandBuffer,
+                sizeof(VkDrawIndexedIndirectCommand) * draw.modelHandle);
+        }
+        lastDrawCount = static_cast<uint32_t>(gpuCullSystem->getDraws().size());
+    }
+
+    void SimpleRenderSystem::renderPerObject(FrameInfo& frameInfo) {
+        bindPipeline(frameInfo, false);
+
+        const SceneStore& scene = frameInfo.scene;
+        const auto& transforms = scene.getTransforms();
+        const auto& modelHandles = scene.getModelHandles();
+
+        uint32_t boundModel = SceneStore::NO_MODEL;
+        for (uint32_t i : visibleSlots) {
+            const uint32_t handle = modelHandles[i];
 
             SimplePushConstantData push{};
-            push.modelMatrix = obj.transform.mat4();
-            push.normalMatrix = obj.transform.normalMatrix();
+            push.modelMatrix = transforms[i].worldMatrix;
+            push.normalMatrix = transforms[i].worldNormalMatrix;
+            // read back as the label by the vertex shader
+            push.normalMatrix[3][3] = static_cast<float>(scene.objectLabel(i));
 
             vkCmdPushConstants(
                 frameInfo.commandBuffer,
@@ -103,9 +205,15 @@ namespace enginev {
                 0,
                 sizeof(SimplePushConstantData),
                 &push);
-            obj.model->bind(frameInfo.commandBuffer);
-            obj.model->draw(frameInfo.commandBuffer);
+
+            Model* model = scene.getModel(handle);
+            if (handle != boundModel) {
+                model->bind(frameInfo.commandBuffer);
+                boundModel = handle;
+            }
+            model->draw(frameInfo.commandBuffer);
         }
+        lastDrawCount = static_cast<uint32_t>(visibleSlots.size());
     }
 
 }
@@ -0,0 +1,46 @@
+#include "thread_pool.hpp"
+#include "cpu_tracer.hpp"
+
+// std
+#include <algorithm>
+
+namespace enginev {
+
+    ThreadPool::ThreadPool(size_t threadCount, const char* threadName) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this, threadName] { workerLoop(threadName); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::workerLoop(const char* threadName) {
+        CpuTracer::setThreadName(threadName);
+
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;  // stopping with nothing left
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+}
@@ -0,0 +1,492 @@
+#include "upload_batcher.hpp"
+#include "cpu_tracer.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace enginev {
+
+    namespace {
+        constexpr VkAccessFlags BUFFER_READ_ACCESS =
+            VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+            VK_ACCESS_SHADER_READ_BIT;
+
+        constexpr VkPipelineStageFlags CONSUMER_STAGES =
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        constexpr uint64_t NO_TIMEOUT = std::numeric_limits<uint64_t>::max();
+    }
+
+    UploadBatcher::UploadBatcher(Device& device, VkDeviceSize capacity)
+        : device{ device }, dedicated{ device.hasDedicatedTransferQueue() }, capacity{ capacity } {
+        // image copies need 4-byte (texel) aligned sources
+        alignment = std::max<VkDeviceSize>(16, device.properties.limits.optimalBufferCopyOffsetAlignment);
+
+        device.createBuffer(
+            capacity,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            stagingBuffer,
+            stagingMemory);
+
+        void* data = nullptr;
+        if (vkMapMemory(device.device(), stagingMemory, 0, capacity, 0, &data) != VK_SUCCESS) {
+            throw std::runtime_error("failed to map upload staging memory!");
+        }
+        mapped = static_cast<uint8_t*>(data);
+
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = device.transferQueueFamily();
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &transferPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+    }
+
+    UploadBatcher::~UploadBatcher() {
+        while (!transferring.empty()) {
+            finishTransfer(*transferring.front(), true);
+        }
+        for (Batch* batch : acquiring) {
+            vkWaitForFences(device.device(), 1, &batch->acquireFence, VK_TRUE, NO_TIMEOUT);
+        }
+        releaseOverflow(pendingOverflow);
+
+        for (Batch& batch : batches) {
+            if (batch.transferCommands == VK_NULL_HANDLE) continue;
+            vkDestroyFence(device.device(), batch.transferFence, nullptr);
+            if (dedicated) {
+                vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &batch.acquireCommands);
+                vkDestroyFence(device.device(), batch.acquireFence, nullptr);
+                vkDestroySemaphore(device.device(), batch.transferDone, nullptr);
+            }
+        }
+        vkDestroyCommandPool(device.device(), transferPool, nullptr);
+
+        vkUnmapMemory(device.device(), stagingMemory);
+        vkDestroyBuffer(device.device(), stagingBuffer, nullptr);
+        vkFreeMemory(device.device(), stagingMemory, nullptr);
+    }
+
+    bool UploadBatcher::allocateFromRing(VkDeviceSize size, VkDeviceSize& offset) {
+        if (!isRingInUse()) {
+            head = tail = 0;
+        }
+
+        const VkDeviceSize start = (head + alignment - 1) / alignment * alignment;
+        if (head >= tail) {
+            if (start + size <= capacity) {
+                offset = start;
+                head = start + size;
+                return true;
+            }
+            // wrap; strictly below tail, so head == tail always means empty
+            if (size < tail) {
+                offset = 0;
+                head = size;
+                return true;
+            }
+            return false;
+        }
+
+        if (start + size < tail) {
+            offset = start;
+            head = start + size;
+            return true;
+        }
+        return false;
+    }
+
+    VkBuffer UploadBatcher::stage(const void* data, VkDeviceSize size, VkDeviceSize& srcOffset) {
+        uploadedBytes += size;
+
+        if (size > capacity) {
+            Overflow own{};
+            device.createBuffer(
+                size,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                own.buffer,
+                own.memory);
+            pendingOverflow.push_back(own);
+
+            void* dst = nullptr;
+            vkMapMemory(device.device(), own.memory, 0, size, 0, &dst);
+            std::memcpy(dst, data, static_cast<size_t>(size));
+            vkUnmapMemory(device.device(), own.memory);
+
+            srcOffset = 0;
+            return own.buffer;
+        }
+
+        VkDeviceSize offset = 0;
+        while (!allocateFromRing(size, offset)) {
+            // the ring is full: wait for the oldest batch to release its part
+            if (pendingUsesRing) {
+                submit();
+            }
+            finishTransfer(*transferring.front(), true);
+        }
+
+        std::memcpy(mapped + offset, data, static_cast<size_t>(size));
+        pendingUsesRing = true;
+        srcOffset = offset;
+        return stagingBuffer;
+    }
+
+    void UploadBatcher::uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset) {
+        if (size == 0) {
+            return;
+        }
+
+        BufferCopy copy{};
+        copy.src = stage(data, size, copy.region.srcOffset);
+        copy.dst = dst;
+        copy.region.dstOffset = dstOffset;
+        copy.region.size = size;
+        bufferCopies.push_back(copy);
+    }
+
+    void UploadBatcher::uploadImage(
+        VkImage image, const void* data, VkDeviceSize size,
+        uint32_t width, uint32_t height, uint32_t layerCount) {
+        ImageCopy copy{};
+        copy.src = stage(data, size, copy.region.bufferOffset);
+        copy.dst = image;
+        copy.region.bufferRowLength = 0;
+        copy.region.bufferImageHeight = 0;
+        copy.region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.region.imageSubresource.mipLevel = 0;
+        copy.region.imageSubresource.baseArrayLayer = 0;
+        copy.region.imageSubresource.layerCount = layerCount;
+        copy.region.imageOffset = { 0, 0, 0 };
+        copy.region.imageExtent = { width, height, 1 };
+        imageCopies.push_back(copy);
+    }
+
+    UploadBatcher::Batch& UploadBatcher::acquireFreeBatch() {
+        poll();
+
+        Batch* batch = nullptr;
+        for (Batch& candidate : batches) {
+            if (candidate.state == BatchState::Free) {
+                batch = &candidate;
+                break;
+            }
+        }
+
+        if (!batch) {
+            // all in flight: the oldest one comes back first
+            if (acquiring.empty()) {
+                batch = transferring.front();
+                finishTransfer(*batch, true);
+            }
+            if (!acquiring.empty()) {
+                batch = acquiring.front();
+                vkWaitForFences(device.device(), 1, &batch->acquireFence, VK_TRUE, NO_TIMEOUT);
+                batch->state = BatchState::Free;
+                acquiring.pop_front();
+            }
+        }
+        assert(batch->state == BatchState::Free);
+
+        if (batch->transferCommands == VK_NULL_HANDLE) {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = transferPool;
+            allocInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(device.device(), &allocInfo, &batch->transferCommands) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate upload command buffer!");
+            }
+
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            if (vkCreateFence(device.device(), &fenceInfo, nullptr, &batch->transferFence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create upload fence!");
+            }
+
+            if (dedicated) {
+                allocInfo.commandPool = device.getCommandPool();
+                if (vkAllocateCommandBuffers(device.device(), &allocInfo, &batch->acquireCommands) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to allocate upload acquire command buffer!");
+                }
+                if (vkCreateFence(device.device(), &fenceInfo, nullptr, &batch->acquireFence) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create upload fence!");
+                }
+
+                VkSemaphoreCreateInfo semaphoreInfo{};
+                semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &batch->transferDone) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create upload semaphore!");
+                }
+            }
+        }
+        return *batch;
+    }
+
+    void UploadBatcher::recordTransfer(Batch& batch) {
+        const uint32_t graphicsFamily = device.graphicsQueueFamily();
+        const uint32_t transferFamily = device.transferQueueFamily();
+        VkCommandBuffer cmd = batch.transferCommands;
+
+        batch.bufferAcquires.clear();
+        batch.imageAcquires.clear();
+
+        vkResetCommandBuffer(cmd, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+
+        if (!imageCopies.empty()) {
+            std::vector<VkImageMemoryBarrier> barriers;
+            for (const ImageCopy& copy : imageCopies) {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = copy.dst;
+                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.baseMipLevel = 0;
+                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.baseArrayLayer = 0;
+                barrier.subresourceRange.layerCount = copy.region.imageSubresource.layerCount;
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barriers.push_back(barrier);
+            }
+            vkCmdPipelineBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 0, nullptr, 0, nullptr,
+                static_cast<uint32_t>(barriers.size()), barriers.data());
+
+            for (const ImageCopy& copy : imageCopies) {
+                vkCmdCopyBufferToImage(
+                    cmd, copy.src, copy.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+            }
+
+            for (VkImageMemoryBarrier& barrier : barriers) {
+                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                if (dedicated) {
+                    // release; the layout change happens once, for both halves
+                    barrier.srcQueueFamilyIndex = transferFamily;
+                    barrier.dstQueueFamilyIndex = graphicsFamily;
+
+                    VkImageMemoryBarrier acquire = barrier;
+                    acquire.srcAccessMask = 0;
+                    batch.imageAcquires.push_back(acquire);
+
+                    barrier.dstAccessMask = 0;
+                }
+            }
+            vkCmdPipelineBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                dedicated ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                          : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 0, nullptr, 0, nullptr,
+                static_cast<uint32_t>(barriers.size()), barriers.data());
+        }
+
+        if (!bufferCopies.empty()) {
+            // one vkCmdCopyBuffer per source/destination pair, with all of
+            // the pair's regions
+            std::stable_sort(bufferCopies.begin(), bufferCopies.end(),
+                [](const BufferCopy& a, const BufferCopy& b) {
+                    return a.src != b.src ? a.src < b.src : a.dst < b.dst;
+                });
+
+            std::vector<VkBufferCopy> regions;
+            for (size_t first = 0; first < bufferCopies.size();) {
+                size_t last = first;
+                regions.clear();
+                while (last < bufferCopies.size() &&
+                    bufferCopies[last].src == bufferCopies[first].src &&
+                    bufferCopies[last].dst == bufferCopies[first].dst) {
+                    regions.push_back(bufferCopies[last].region);
+                    ++last;
+                }
+                vkCmdCopyBuffer(
+                    cmd, bufferCopies[first].src, bufferCopies[first].dst,
+                    static_cast<uint32_t>(regions.size()), regions.data());
+                first = last;
+            }
+
+            if (dedicated) {
+                std::vector<VkBufferMemoryBarrier> releases;
+                releases.reserve(bufferCopies.size());
+                for (const BufferCopy& copy : bufferCopies) {
+                    VkBufferMemoryBarrier barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                    barrier.dstAccessMask = 0;
+                    barrier.srcQueueFamilyIndex = transferFamily;
+                    barrier.dstQueueFamilyIndex = graphicsFamily;
+                    barrier.buffer = copy.dst;
+                    barrier.offset = copy.region.dstOffset;
+                    barrier.size = copy.region.size;
+                    releases.push_back(barrier);
+
+                    barrier.srcAccessMask = 0;
+                    barrier.dstAccessMask = BUFFER_READ_ACCESS;
+                    batch.bufferAcquires.push_back(barrier);
+                }
+                vkCmdPipelineBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                    0, 0, nullptr,
+                    static_cast<uint32_t>(releases.size()), releases.data(),
+                    0, nullptr);
+            } else {
+                VkMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = BUFFER_READ_ACCESS;
+                vkCmdPipelineBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES,
+                    0, 1, &barrier, 0, nullptr, 0, nullptr);
+            }
+        }
+
+        vkEndCommandBuffer(cmd);
+    }
+
+    uint64_t UploadBatcher::submit() {
+        if (!hasPending()) {
+            return submittedTicket;
+        }
+        CpuTracer::Scope trace{ "UploadBatcher::submit" };
+
+        Batch& batch = acquireFreeBatch();
+        recordTransfer(batch);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.transferCommands;
+        if (dedicated) {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &batch.transferDone;
+        }
+        if (vkQueueSubmit(device.transferQueue(), 1, &submitInfo, batch.transferFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload batch!");
+        }
+
+        batch.state = BatchState::Transferring;
+        batch.ticket = ++submittedTicket;
+        batch.ringEnd = head;
+        batch.overflow = std::move(pendingOverflow);
+        pendingOverflow.clear();
+        transferring.push_back(&batch);
+
+        bufferCopies.clear();
+        imageCopies.clear();
+        pendingUsesRing = false;
+        ++submitCount;
+
+        if (!dedicated) {
+            // same queue: the trailing barrier already orders later work
+            completedTicket = batch.ticket;
+        }
+        return batch.ticket;
+    }
+
+    bool UploadBatcher::finishTransfer(Batch& batch, bool wait) {
+        assert(!transferring.empty() && transferring.front() == &batch);
+
+        if (wait) {
+            vkWaitForFences(device.device(), 1, &batch.transferFence, VK_TRUE, NO_TIMEOUT);
+        } else if (vkGetFenceStatus(device.device(), batch.transferFence) != VK_SUCCESS) {
+            return false;
+        }
+        vkResetFences(device.device(), 1, &batch.transferFence);
+
+        transferring.pop_front();
+        tail = batch.ringEnd;
+        releaseOverflow(batch.overflow);
+
+        if (!dedicated) {
+            batch.state = BatchState::Free;
+            return true;
+        }
+
+        // acquire on the graphics queue; the semaphore is signaled already,
+        // waiting on it still makes the release visible to this queue
+        VkCommandBuffer cmd = batch.acquireCommands;
+        vkResetCommandBuffer(cmd, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cmd, &beginInfo);
+        vkCmdPipelineBarrier(
+            cmd,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, CONSUMER_STAGES,
+            0, 0, nullptr,
+            static_cast<uint32_t>(batch.bufferAcquires.size()), batch.bufferAcquires.data(),
+            static_cast<uint32_t>(batch.imageAcquires.size()), batch.imageAcquires.data());
+        vkEndCommandBuffer(cmd);
+
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &batch.transferDone;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmd;
+
+        vkResetFences(device.device(), 1, &batch.acquireFence);
+        if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, batch.acquireFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload acquire!");
+        }
+
+        batch.state = BatchState::Acquiring;
+        acquiring.push_back(&batch);
+        completedTicket = batch.ticket;
+        return true;
+    }
+
+    uint64_t UploadBatcher::poll() {
+        while (!acquiring.empty() &&
+            vkGetFenceStatus(device.device(), acquiring.front()->acquireFence) == VK_SUCCESS) {
+            acquiring.front()->state = BatchState::Free;
+            acquiring.pop_front();
+        }
+        while (!transferring.empty() && finishTransfer(*transferring.front(), false)) {
+        }
+        return completedTicket;
+    }
+
+    void UploadBatcher::flush() {
+        submit();
+        while (!transferring.empty()) {
+            finishTransfer(*transferring.front(), true);
+        }
+    }
+
+    void UploadBatcher::releaseOverflow(std::vector<Overflow>& buffers) {
+        for (const Overflow& own : buffers) {
+            vkDestroyBuffer(device.device(), own.buffer, nullptr);
+            vkFreeMemory(device.device(), own.memory, nullptr);
+        }
+        buffers.clear();
+    }
+}